@@ -0,0 +1,221 @@
+#include "AssetBundle.h"
+
+// check OS, include file mapping API
+#ifdef _WIN32
+	#define WIN32_LEAN_AND_MEAN
+	#define NOMINMAX
+	#define NOGDI
+	#include <windows.h>
+#else
+	#include <sys/mman.h>
+	#include <sys/stat.h>
+	#include <fcntl.h>
+	#include <unistd.h>
+#endif
+
+// Constructor, nothing mapped
+AssetBundle::AssetBundle() {
+
+	// no file or mapping yet
+	mapped = NULL;
+	mappedSize = 0;
+#ifdef _WIN32
+	fileHandle = INVALID_HANDLE_VALUE;
+	mappingHandle = NULL;
+#else
+	fileHandle = -1;
+#endif
+}
+
+// Destructor, unmaps the bundle (images found in it must not outlive it)
+AssetBundle::~AssetBundle() {
+
+	// release mapping and file
+	close();
+}
+
+// Maps a bundle file read-only and checks its header, returns false (reason in getError) if it can't be used
+bool AssetBundle::open(const std::string& path) {
+
+	// drop any earlier bundle
+	close();
+
+#ifdef _WIN32
+
+	// open file and map whole file read-only
+	fileHandle = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, NULL);
+	LARGE_INTEGER fileSize;
+	if (fileHandle == INVALID_HANDLE_VALUE || !GetFileSizeEx(fileHandle, &fileSize) || fileSize.QuadPart == 0) {
+		error = "Can't Open " + path;
+		close();
+		return false;
+	}
+	mappingHandle = CreateFileMappingA(fileHandle, NULL, PAGE_READONLY, 0, 0, NULL);
+	mapped = mappingHandle != NULL ? static_cast<const unsigned char*>(MapViewOfFile(mappingHandle, FILE_MAP_READ, 0, 0, 0)) : NULL;
+	mappedSize = static_cast<size_t>(fileSize.QuadPart);
+#else
+
+	// open file and map whole file read-only
+	fileHandle = ::open(path.c_str(), O_RDONLY);
+	struct stat fileStatus;
+	if (fileHandle < 0 || fstat(fileHandle, &fileStatus) != 0 || fileStatus.st_size == 0) {
+		error = "Can't Open " + path;
+		close();
+		return false;
+	}
+	void* view = mmap(NULL, static_cast<size_t>(fileStatus.st_size), PROT_READ, MAP_PRIVATE, fileHandle, 0);
+	mapped = view != MAP_FAILED ? static_cast<const unsigned char*>(view) : NULL;
+	mappedSize = static_cast<size_t>(fileStatus.st_size);
+
+	// ask the kernel to start paging the bundle in now, before the first screen needs it
+	if (mapped != NULL)
+		madvise(view, mappedSize, MADV_WILLNEED);
+#endif
+
+	// check if mapping succeeded
+	if (mapped == NULL) {
+		error = "Can't Map " + path;
+		close();
+		return false;
+	}
+
+	// check header fits and is recognized
+	const Header* header = reinterpret_cast<const Header*>(mapped);
+	if (mappedSize < sizeof(Header) || memcmp(header->magic, ASSET_BUNDLE_MAGIC, 4) != 0 || header->version != ASSET_BUNDLE_VERSION) {
+		error = path + " Is Not An Asset Bundle (Or Was Packed By Another Version)";
+		close();
+		return false;
+	}
+
+	// check asset table fits
+	if ((mappedSize - sizeof(Header)) / sizeof(Entry) < header->count) {
+		error = path + " Is Truncated";
+		close();
+		return false;
+	}
+
+	// report success
+	error.clear();
+	return true;
+}
+
+// Finds a named image, validates it and wraps its mapped pixels, returns false (reason in getError) if missing or malformed
+bool AssetBundle::find(const std::string& name, cv::Mat& image) {
+
+	// check a bundle is open
+	if (mapped == NULL) {
+		error = "No Asset Bundle Open";
+		return false;
+	}
+
+	// walk asset table
+	const Header* header = reinterpret_cast<const Header*>(mapped);
+	const Entry* entries = reinterpret_cast<const Entry*>(mapped + sizeof(Header));
+	for (uint32_t i = 0; i < header->count; i++) {
+
+		// check name (stored zero padded)
+		const Entry& entry = entries[i];
+		if (strncmp(entry.name, name.c_str(), ASSET_NAME_LENGTH) != 0)
+			continue;
+
+		// check format is a sane 8-bit image whose rows fit their stride
+		if (entry.rows <= 0 || entry.cols <= 0 || CV_MAT_DEPTH(entry.type) != CV_8U || entry.step < static_cast<uint64_t>(entry.cols) * CV_MAT_CN(entry.type)) {
+			error = "Asset " + name + " Has A Bad Image Format";
+			return false;
+		}
+
+		// check pixels are aligned and lie inside the file
+		if (entry.offset % ASSET_BUNDLE_ALIGNMENT != 0 || entry.size != static_cast<uint64_t>(entry.rows) * entry.step || entry.offset > mappedSize || entry.size > mappedSize - entry.offset) {
+			error = "Asset " + name + " Is Truncated Or Misaligned";
+			return false;
+		}
+
+		// wrap mapped pixels (read-only pages, never written)
+		image = cv::Mat(entry.rows, entry.cols, entry.type, const_cast<unsigned char*>(mapped + entry.offset), entry.step);
+
+		// report success
+		error.clear();
+		return true;
+	}
+
+	// report missing asset
+	error = "Asset " + name + " Missing From Bundle";
+	return false;
+}
+
+// Reports why the last open or find failed
+std::string AssetBundle::getError() {
+
+	// report reason
+	return error;
+}
+
+// Writes named 8-bit images into a bundle, each aligned to ASSET_BUNDLE_ALIGNMENT, returns false if the file can't be written
+bool AssetBundle::pack(const std::string& path, const std::vector<std::string>& names, const std::vector<cv::Mat>& images) {
+
+	// open output
+	std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+
+	// header first
+	Header header = Header();
+	memcpy(header.magic, ASSET_BUNDLE_MAGIC, 4);
+	header.version = ASSET_BUNDLE_VERSION;
+	header.count = static_cast<uint32_t>(images.size());
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+	// lay out asset table, pixels start after it, each image on an aligned offset
+	std::vector<Entry> entries(images.size());
+	uint64_t offset = sizeof(Header) + sizeof(Entry) * images.size();
+	for (size_t i = 0; i < images.size(); i++) {
+		offset = (offset + ASSET_BUNDLE_ALIGNMENT - 1) / ASSET_BUNDLE_ALIGNMENT * ASSET_BUNDLE_ALIGNMENT;
+		strncpy(entries[i].name, names[i].c_str(), ASSET_NAME_LENGTH - 1);
+		entries[i].rows = images[i].rows;
+		entries[i].cols = images[i].cols;
+		entries[i].type = images[i].type();
+		entries[i].step = static_cast<uint32_t>(images[i].cols * images[i].elemSize());
+		entries[i].offset = offset;
+		entries[i].size = static_cast<uint64_t>(entries[i].rows) * entries[i].step;
+		offset += entries[i].size;
+	}
+	file.write(reinterpret_cast<const char*>(entries.data()), sizeof(Entry) * entries.size());
+
+	// write pixels, padding up to each image's offset
+	for (size_t i = 0; i < images.size(); i++) {
+		static const char padding[ASSET_BUNDLE_ALIGNMENT] = {};
+		file.write(padding, static_cast<std::streamsize>(entries[i].offset - static_cast<uint64_t>(file.tellp())));
+		for (int y = 0; y < images[i].rows; y++)
+			file.write(reinterpret_cast<const char*>(images[i].ptr(y)), entries[i].step);
+	}
+
+	// report write success
+	return file.good();
+}
+
+// Unmaps the bundle and closes its file
+void AssetBundle::close() {
+
+#ifdef _WIN32
+
+	// release view, mapping and file
+	if (mapped != NULL)
+		UnmapViewOfFile(mapped);
+	if (mappingHandle != NULL)
+		CloseHandle(mappingHandle);
+	if (fileHandle != INVALID_HANDLE_VALUE)
+		CloseHandle(fileHandle);
+	mappingHandle = NULL;
+	fileHandle = INVALID_HANDLE_VALUE;
+#else
+
+	// release mapping and file
+	if (mapped != NULL)
+		munmap(const_cast<unsigned char*>(mapped), mappedSize);
+	if (fileHandle >= 0)
+		::close(fileHandle);
+	fileHandle = -1;
+#endif
+
+	// nothing mapped
+	mapped = NULL;
+	mappedSize = 0;
+}
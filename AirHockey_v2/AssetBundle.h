@@ -0,0 +1,66 @@
+#pragma once
+#include "GameData.h"
+#include <vector>
+
+// Pre-decoded image bundle, packed at build time and memory-mapped read-only at startup
+// Images are wrapped in place (no decode, no copy), so any write to an asset faults instead of corrupting it
+class AssetBundle {
+public:
+
+	// Constructor, nothing mapped
+	AssetBundle();
+
+	// Destructor, unmaps the bundle (images found in it must not outlive it)
+	~AssetBundle();
+
+	// Maps a bundle file read-only and checks its header, returns false (reason in getError) if it can't be used
+	bool open(const std::string&);
+
+	// Finds a named image, validates it and wraps its mapped pixels, returns false (reason in getError) if missing or malformed
+	bool find(const std::string&, cv::Mat&);
+
+	// Reports why the last open or find failed
+	std::string getError();
+
+	// Writes named 8-bit images into a bundle, each aligned to ASSET_BUNDLE_ALIGNMENT, returns false if the file can't be written
+	static bool pack(const std::string&, const std::vector<std::string>&, const std::vector<cv::Mat>&);
+
+private:
+
+	// File header, followed by the asset table
+	struct Header {
+		char magic[4];		// ASSET_BUNDLE_MAGIC
+		uint32_t version;	// ASSET_BUNDLE_VERSION
+		uint32_t count;		// number of assets in the table
+		uint32_t reserved;	// zero
+	};
+
+	// Asset table entry, pixels are continuous rows at offset
+	struct Entry {
+		char name[ASSET_NAME_LENGTH];	// asset name, zero padded
+		int32_t rows;					// image rows
+		int32_t cols;					// image columns
+		int32_t type;					// OpenCV image type
+		uint32_t step;					// bytes per row
+		uint64_t offset;				// file offset of the first row
+		uint64_t size;					// bytes of pixel data
+	};
+
+	// Unmaps the bundle and closes its file
+	void close();
+
+	// mapped file contents (NULL when closed)
+	const unsigned char* mapped;
+	size_t mappedSize;
+
+	// open file and mapping handles
+#ifdef _WIN32
+	void* fileHandle;
+	void* mappingHandle;
+#else
+	int fileHandle;
+#endif
+
+	// reason the last open or find failed
+	std::string error;
+};
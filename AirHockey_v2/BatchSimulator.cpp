@@ -0,0 +1,247 @@
+#include "BatchSimulator.h"
+
+// Constructor, no games
+BatchSimulator::BatchSimulator() : pendingBlocks(0) {
+
+	// step games exactly as the live game does
+	stepDuration_micros = 1e6L / (GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO);
+}
+
+// Destructor, releases every game's table, physics and CPU opponents
+BatchSimulator::~BatchSimulator() {
+
+	// release physics and opponents before the tables they point at
+	for (size_t i = 0; i < physics.size(); i++) {
+		delete physics[i];
+		delete paddleOne_opponents[i];
+		delete paddleTwo_opponents[i];
+		delete tables[i];
+	}
+}
+
+// Adds a game with the given constants, paddle controllers (PADDLE_CONTROL_...) and serve seed, returns its index
+int BatchSimulator::addGame(const PhysicsParameters& parameters, const int paddleOne_control, const int paddleTwo_control, const unsigned long long seed) {
+
+	// size table as the sensor does at the default projector distance
+	TableState* table = new TableState();
+	table->setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+
+	// append game's entry to every array
+	tables.push_back(table);
+	physics.push_back(new Physics(table, 1, parameters));
+	paddleOne_opponents.push_back(paddleOne_control == PADDLE_CONTROL_AI ? new PaddleAI(table, true, parameters) : NULL);
+	paddleTwo_opponents.push_back(paddleTwo_control == PADDLE_CONTROL_AI ? new PaddleAI(table, false, parameters) : NULL);
+	paddleOne_positions.push_back(Vec2(table->table_centerLeft[0], table->table_centerLeft[1]));
+	paddleTwo_positions.push_back(Vec2(table->table_centerRight[0], table->table_centerRight[1]));
+	simulatedTimes.push_back(0);
+	stoppedTimes.push_back(0);
+	goals_playerOne.push_back(0);
+	goals_playerTwo.push_back(0);
+	longestRallies.push_back(0);
+	stalls.push_back(0);
+	rallyStartHits.push_back(0);
+	rallyHitTotals.push_back(0);
+	peakPuckSpeedsSquared.push_back(0);
+
+	// scramble seed into a nonzero generator state (xorshift sticks at zero)
+	unsigned long long randomState = (seed + 1) * 0x9E3779B97F4A7C15ULL;
+	randomStates.push_back(randomState != 0 ? randomState : 1);
+
+	// open the game with a serve
+	int game = static_cast<int>(tables.size()) - 1;
+	servePuck(game);
+	return game;
+}
+
+// Reports the number of games
+int BatchSimulator::getGameCount() {
+
+	// report number of games
+	return static_cast<int>(tables.size());
+}
+
+// Simulates every game for the given game time (secs) on the pool, returns once all are done (don't call from a pool worker)
+void BatchSimulator::run(WorkerPool& pool, const double duration_secs) {
+
+	// calculate whole physics steps covering the duration
+	long long steps = static_cast<long long>(std::llround(duration_secs * 1e6 / static_cast<double>(stepDuration_micros)));
+	int gameCount = getGameCount();
+	if (steps <= 0 || gameCount == 0)
+		return;
+
+	// count blocks before queueing any, a block may finish before the rest are queued
+	{
+		std::lock_guard<std::mutex> lock(blocksLock);
+		pendingBlocks = (gameCount + SIMULATION_GAMES_PER_TASK - 1) / SIMULATION_GAMES_PER_TASK;
+	}
+
+	// queue one task per block of games
+	for (int first = 0; first < gameCount; first += SIMULATION_GAMES_PER_TASK) {
+		int last = std::min(first + SIMULATION_GAMES_PER_TASK, gameCount);
+		pool.submit([this, first, last, steps] { simulateGames(first, last, steps); });
+	}
+
+	// wait for every block
+	std::unique_lock<std::mutex> lock(blocksLock);
+	blocksDone.wait(lock, [this] { return pendingBlocks == 0; });
+}
+
+// Reports a game's statistics so far
+SimulationStatistics BatchSimulator::getStatistics(const int game) {
+
+	// gather game's entries
+	SimulationStatistics statistics;
+	statistics.simulatedTime = simulatedTimes[game];
+	statistics.goals_playerOne = goals_playerOne[game];
+	statistics.goals_playerTwo = goals_playerTwo[game];
+	statistics.longestRally = longestRallies[game];
+	statistics.peakPuckSpeed = std::sqrt(peakPuckSpeedsSquared[game]);
+	statistics.stalls = stalls[game];
+
+	// derive rates, zero before any time or goals
+	int goals = goals_playerOne[game] + goals_playerTwo[game];
+	statistics.goalsPerMinute = (simulatedTimes[game] > 0) ? goals * 60.0 / simulatedTimes[game] : 0;
+	statistics.meanRallyLength = (goals > 0) ? static_cast<double>(rallyHitTotals[game]) / goals : 0;
+	return statistics;
+}
+
+// Pool task, simulates a block of games for the given number of physics steps, one game at a time
+void BatchSimulator::simulateGames(const int first, const int last, const long long steps) {
+
+	// convert step length to seconds
+	const double stepDuration_secs = static_cast<double>(stepDuration_micros * 1e-6);
+
+	// iterate through games, each stays cache-hot for its whole run
+	for (int game = first; game < last; game++) {
+
+		// game's physics and its state as of the last step
+		Physics* gamePhysics = physics[game];
+		const WorldState& state = gamePhysics->getState();
+
+		// step game
+		for (long long step = 0; step < steps; step++) {
+
+			// move paddles for the step and step physics to its end
+			movePaddles(game, state, stepDuration_secs);
+			simulatedTimes[game] += stepDuration_secs;
+			gamePhysics->tick(stepDuration_micros, simulatedTimes[game]);
+
+			// track fastest puck
+			double speedSquared = state.puck_velocities[0].lengthSquared();
+			peakPuckSpeedsSquared[game] = std::max(peakPuckSpeedsSquared[game], speedSquared);
+
+			// check for a goal, score it and serve again straight away (no celebration in a simulation)
+			int goal = gamePhysics->detectGoals();
+			if (goal != 0) {
+				if (goal == 1)
+					goals_playerOne[game]++;
+				else
+					goals_playerTwo[game]++;
+
+				// close rally the goal ended
+				int rally = static_cast<int>(gamePhysics->getPaddleHitCount() - rallyStartHits[game]);
+				rallyHitTotals[game] += rally;
+				longestRallies[game] = std::max(longestRallies[game], rally);
+				servePuck(game);
+				continue;
+			}
+
+			// check if puck has been stopped long enough that neither paddle will reach it, serve again (the rally is dropped)
+			stoppedTimes[game] = (speedSquared == 0) ? stoppedTimes[game] + stepDuration_secs : 0;
+			if (stoppedTimes[game] >= SIMULATION_STALL_TIME) {
+				stalls[game]++;
+				servePuck(game);
+			}
+		}
+	}
+
+	// report block done
+	std::lock_guard<std::mutex> lock(blocksLock);
+	pendingBlocks--;
+	blocksDone.notify_all();
+}
+
+// Moves both of a game's paddles for the next step and publishes them to its physics
+void BatchSimulator::movePaddles(const int game, const WorldState& state, const double stepDuration_secs) {
+
+	// time the step will end at
+	double stepTime = simulatedTimes[game] + stepDuration_secs;
+
+	// steer both paddles
+	Vec2 paddleOne_target = steerPaddle(game, true, state, stepDuration_secs);
+	Vec2 paddleTwo_target = steerPaddle(game, false, state, stepDuration_secs);
+
+	// publish as steadily tracked estimates captured at the step's end, so physics uses them as they are
+	PaddleState paddles;
+	paddles.paddleOne_position = paddleOne_target;
+	paddles.paddleOne_velocity = (paddleOne_target - paddleOne_positions[game]) / stepDuration_secs;
+	paddles.paddleTwo_position = paddleTwo_target;
+	paddles.paddleTwo_velocity = (paddleTwo_target - paddleTwo_positions[game]) / stepDuration_secs;
+	paddles.paddleOne_confidence = 1;
+	paddles.paddleTwo_confidence = 1;
+	paddles.trace.captured = stepTime;
+	paddles.trace.taken = stepTime;
+	paddles.trace.published = stepTime;
+	paddles.trace.stepped = 0;
+	tables[game]->paddle_state.store(paddles);
+
+	// remember positions for the next step's velocities
+	paddleOne_positions[game] = paddleOne_target;
+	paddleTwo_positions[game] = paddleTwo_target;
+}
+
+// Calculates where a paddle wants to be next step under its controller
+Vec2 BatchSimulator::steerPaddle(const int game, const bool isPaddleOne, const WorldState& state, const double stepDuration_secs) {
+
+	// gather table and paddle
+	const TableState* table = tables[game];
+	const Vec2& paddle_position = isPaddleOne ? paddleOne_positions[game] : paddleTwo_positions[game];
+
+	// check if the CPU opponent plays this paddle
+	PaddleAI* opponent = isPaddleOne ? paddleOne_opponents[game] : paddleTwo_opponents[game];
+	if (opponent != NULL)
+		return opponent->steer(state, paddle_position, stepDuration_secs);
+
+	// sweep across the goal mouth in front of the goal, paddles half a sweep apart
+	double homeX = isPaddleOne ? WALL_PADDING_THICKNESS + 3 * PADDLE_RADIUS : table->table_width - WALL_PADDING_THICKNESS - 3 * PADDLE_RADIUS;
+	double phase = 2 * CV_PI * PADDLE_SCRIPT_FREQUENCY * simulatedTimes[game] + (isPaddleOne ? 0 : CV_PI);
+	Vec2 target(homeX, table->table_height / 2 + (physics[game]->getParameters().goalWidth / 2 + PADDLE_RADIUS) * std::sin(phase));
+
+	// walk to the sweep no faster than a player could (the sweep itself is slower)
+	Vec2 offset = target - paddle_position;
+	double distance = offset.length();
+	double reach = PADDLE_AI_MAX_SPEED * stepDuration_secs;
+	if (distance > reach)
+		target = paddle_position + offset * (reach / distance);
+	return target;
+}
+
+// Puts a game's puck in the middle and sends it towards a random side at serve speed
+void BatchSimulator::servePuck(const int game) {
+
+	// draw side and angle off the table's long axis
+	double side = (nextRandom(game) < 0.5) ? -1.0 : 1.0;
+	double angle = (2 * nextRandom(game) - 1) * SIMULATION_SERVE_ANGLE;
+
+	// launch from the table center
+	const TableState* table = tables[game];
+	Vec2 velocity(side * SIMULATION_SERVE_SPEED * std::cos(angle), SIMULATION_SERVE_SPEED * std::sin(angle));
+	physics[game]->launchPuck(0, Vec2(table->table_center[0], table->table_center[1]), velocity);
+
+	// start a new rally
+	rallyStartHits[game] = physics[game]->getPaddleHitCount();
+	stoppedTimes[game] = 0;
+}
+
+// Draws a uniform random number in [0, 1) from a game's generator
+double BatchSimulator::nextRandom(const int game) {
+
+	// advance xorshift64* state
+	unsigned long long& randomState = randomStates[game];
+	randomState ^= randomState >> 12;
+	randomState ^= randomState << 25;
+	randomState ^= randomState >> 27;
+
+	// scale top 53 bits of the scrambled output to [0, 1)
+	return static_cast<double>((randomState * 2685821657736338717ULL) >> 11) / 9007199254740992.0;
+}
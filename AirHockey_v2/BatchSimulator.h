@@ -0,0 +1,95 @@
+#pragma once
+#include "GameData.h"
+#include "PaddleAI.h"
+#include "Physics.h"
+#include "WorkerPool.h"
+#include <vector>
+
+// Outcome of one simulated game so far
+struct SimulationStatistics {
+	double simulatedTime;		// game time simulated (secs)
+	int goals_playerOne;		// goals scored by each player
+	int goals_playerTwo;
+	double goalsPerMinute;		// goals (either player) per minute of game time
+	double meanRallyLength;		// paddle hits between a serve and the goal it ended in, averaged over goals
+	int longestRally;			// most paddle hits before a goal
+	double peakPuckSpeed;		// fastest the puck moved at the end of any physics step (units/s)
+	int stalls;					// times a stopped puck had to be served again
+};
+
+// Headless batch of independent games stepping the real physics, for sweeping physics constants without playing
+// Per-game state lives in parallel arrays (one entry per game), a pool task steps a contiguous block of games
+class BatchSimulator {
+public:
+
+	// Constructor, no games
+	BatchSimulator();
+
+	// Destructor, releases every game's table, physics and CPU opponents
+	~BatchSimulator();
+
+	// Adds a game with the given constants, paddle controllers (PADDLE_CONTROL_...) and serve seed, returns its index
+	int addGame(const PhysicsParameters&, const int, const int, const unsigned long long);
+
+	// Reports the number of games
+	int getGameCount();
+
+	// Simulates every game for the given game time (secs) on the pool, returns once all are done (don't call from a pool worker)
+	void run(WorkerPool&, const double);
+
+	// Reports a game's statistics so far
+	SimulationStatistics getStatistics(const int);
+
+private:
+
+	// Pool task, simulates a block of games for the given number of physics steps, one game at a time
+	void simulateGames(const int, const int, const long long);
+
+	// Moves both of a game's paddles for the next step and publishes them to its physics
+	void movePaddles(const int, const WorldState&, const double);
+
+	// Calculates where a paddle wants to be next step under its controller
+	Vec2 steerPaddle(const int, const bool, const WorldState&, const double);
+
+	// Puts a game's puck in the middle and sends it towards a random side at serve speed
+	void servePuck(const int);
+
+	// Draws a uniform random number in [0, 1) from a game's generator
+	double nextRandom(const int);
+
+	// length (us) of one physics step, the game's own step
+	long double stepDuration_micros;
+
+	// tables and physics, one per game
+	std::vector<TableState*> tables;
+	std::vector<Physics*> physics;
+
+	// CPU opponents playing AI-controlled paddles (NULL for scripted paddles)
+	std::vector<PaddleAI*> paddleOne_opponents;
+	std::vector<PaddleAI*> paddleTwo_opponents;
+
+	// paddle positions as of the last step
+	std::vector<Vec2> paddleOne_positions;
+	std::vector<Vec2> paddleTwo_positions;
+
+	// serve generator states (xorshift)
+	std::vector<unsigned long long> randomStates;
+
+	// game time simulated and time the puck has been stopped (secs)
+	std::vector<double> simulatedTimes;
+	std::vector<double> stoppedTimes;
+
+	// running statistics
+	std::vector<int> goals_playerOne;
+	std::vector<int> goals_playerTwo;
+	std::vector<int> longestRallies;
+	std::vector<int> stalls;
+	std::vector<unsigned long> rallyStartHits;
+	std::vector<unsigned long> rallyHitTotals;
+	std::vector<double> peakPuckSpeedsSquared;
+
+	// blocks of games still running, signalled as each finishes
+	std::mutex blocksLock;
+	std::condition_variable blocksDone;
+	int pendingBlocks;
+};
@@ -0,0 +1,231 @@
+#include "BlobTracker.h"
+
+using namespace cv;
+using namespace std;
+
+// Constructor, sets brightness threshold, blob area limits and dilation radius (full-resolution pixels) and pixel stride
+BlobTracker::BlobTracker(const int threshold, const int minimumArea, const int maximumArea, const int dilationRadius, const int sampleStride) {
+
+	// store detection parameters
+	brightnessThreshold = threshold;
+	minArea = minimumArea;
+	maxArea = maximumArea;
+	dilation = max(dilationRadius, 0);
+	stride = (sampleStride > 0) ? sampleStride : 1;
+
+	// one scan position per earlier row a run can join across (most at stride 1)
+	cursors.resize(2 * dilation + 2);
+
+	// no scratch growth yet
+	allocationCount = 0;
+}
+
+// Finds bright blobs inside a region of the frame, appends their centroids to points, returns number found
+int BlobTracker::detect(const Mat& frame, const Rect& requestedRegion, std::vector<KeyPoint>& points) {
+
+	// clip region to frame
+	Rect region = requestedRegion & Rect(0, 0, frame.cols, frame.rows);
+
+	// check if region has any pixels to search
+	if (region.width <= 0 || region.height <= 0)
+		return 0;
+
+	// calculate number of sampled columns and rows
+	const int columns = (region.width + stride - 1) / stride;
+	const int sampledRows = (region.height + stride - 1) / stride;
+	const int channels = frame.channels();
+	const uchar threshold = static_cast<uchar>(brightnessThreshold);
+
+	// dark sampled columns and rows bridged between runs of one blob (dilating both sides closes gaps up to twice the radius)
+	const int gapColumns = 2 * dilation / stride;
+	const int gapRows = 2 * dilation / stride;
+
+	// make sure scratch is large enough for this region (only grows), a sampled row holds at most one run per two columns
+	reserveScratch(static_cast<size_t>(columns), static_cast<size_t>(sampledRows), static_cast<size_t>(sampledRows) * ((columns + 1) / 2));
+
+	// reset per-frame state
+	runs.clear();
+	parent.clear();
+	rowStarts.clear();
+
+	// iterate through sampled rows
+	for (int y = region.y; y < region.y + region.height; y += stride) {
+
+		// first pixel of region on this row
+		const uchar* pixel = frame.ptr<uchar>(y) + region.x * channels;
+
+		// threshold pass, flag pixels where any channel is brighter than the threshold
+		if (channels == 3 && stride == 1)
+			for (int i = 0; i < columns; i++)
+				rowMask[i] = (pixel[3 * i] > threshold) | (pixel[3 * i + 1] > threshold) | (pixel[3 * i + 2] > threshold);
+		else if (channels == 1 && stride == 1)
+			for (int i = 0; i < columns; i++)
+				rowMask[i] = (pixel[i] > threshold);
+		else
+			for (int i = 0; i < columns; i++) {
+				uchar brightest = 0;
+				for (int c = 0; c < channels; c++)
+					brightest = max(brightest, pixel[i * stride * channels + c]);
+				rowMask[i] = (brightest > threshold);
+			}
+
+		// index where this row's runs begin
+		size_t rowStart = runs.size();
+		rowStarts.push_back(rowStart);
+
+		// earlier rows close enough to join (the row before for plain 8-connectivity), scan each alongside this row
+		const int row = static_cast<int>(rowStarts.size()) - 1;
+		const int earlierRows = min(gapRows + 1, row);
+		for (int k = 1; k <= earlierRows; k++)
+			cursors[k] = rowStarts[row - k];
+
+		// extract runs of flagged pixels
+		for (int i = 0; i < columns; ) {
+
+			// skip dark pixels, eight at a time where possible
+			if (!rowMask[i]) {
+				uint64_t block;
+				while (i + 8 <= columns && (memcpy(&block, &rowMask[i], sizeof(block)), block == 0))
+					i += 8;
+				while (i < columns && !rowMask[i])
+					i++;
+				continue;
+			}
+
+			// find end of bright run
+			int start = i;
+			while (i < columns && rowMask[i])
+				i++;
+
+			// record run as its own label
+			Run run = { y, start, i };
+			int label = static_cast<int>(runs.size());
+			runs.push_back(run);
+			parent.push_back(label);
+
+			// merge with the run before it on this row if the gap between them is bridged
+			if (runs.size() - 1 > rowStart && start - runs[label - 1].end <= gapColumns)
+				parent[label] = findRoot(label - 1);
+
+			// iterate through earlier rows within reach
+			for (int k = 1; k <= earlierRows; k++) {
+				size_t rowEnd = rowStarts[row - k + 1];
+
+				// skip runs that end before this one can reach them
+				while (cursors[k] < rowEnd && runs[cursors[k]].end + gapColumns < start)
+					cursors[k]++;
+
+				// merge with every run in reach of this one (diagonals included)
+				for (size_t j = cursors[k]; j < rowEnd && runs[j].start <= i + gapColumns; j++) {
+					int rootA = findRoot(label), rootB = findRoot(static_cast<int>(j));
+					if (rootA != rootB)
+						parent[max(rootA, rootB)] = min(rootA, rootB);
+				}
+			}
+		}
+	}
+
+	// clear blob accumulators and bounds
+	area.assign(runs.size(), 0.0);
+	sumX.assign(runs.size(), 0.0);
+	sumY.assign(runs.size(), 0.0);
+	minX.assign(runs.size(), INT_MAX);
+	maxX.assign(runs.size(), INT_MIN);
+	minY.assign(runs.size(), INT_MAX);
+	maxY.assign(runs.size(), INT_MIN);
+
+	// accumulate area, coordinate sums and bounds (first and last sampled pixels) onto each root run
+	for (size_t i = 0; i < runs.size(); i++) {
+		int root = findRoot(static_cast<int>(i));
+		double length = runs[i].end - runs[i].start;
+		area[root] += length;
+		sumX[root] += (region.x + stride * (runs[i].start + runs[i].end - 1) * 0.5) * length;
+		sumY[root] += runs[i].row * length;
+		minX[root] = min(minX[root], region.x + stride * runs[i].start);
+		maxX[root] = max(maxX[root], region.x + stride * (runs[i].end - 1));
+		minY[root] = min(minY[root], runs[i].row);
+		maxY[root] = max(maxY[root], runs[i].row);
+	}
+
+	// emit centroids of blobs with acceptable area
+	int found = 0;
+	for (size_t i = 0; i < runs.size(); i++) {
+
+		// only roots carry totals
+		if (parent[i] != static_cast<int>(i))
+			continue;
+
+		// convert sampled area to full-resolution pixels
+		double fullArea = area[i] * stride * stride;
+
+		// grow it by the dilation (a square of the radius swept around the blob's extent, exact for convex blobs), check limits
+		double width = maxX[i] - minX[i] + stride, height = maxY[i] - minY[i] + stride;
+		double dilatedArea = fullArea + 2.0 * dilation * (width + height) + 4.0 * dilation * dilation;
+		if (dilatedArea < minArea || dilatedArea > maxArea)
+			continue;
+
+		// record centroid, size is diameter of a circle with the same area
+		points.push_back(KeyPoint(Point2f(static_cast<float>(sumX[i] / area[i]), static_cast<float>(sumY[i] / area[i])), static_cast<float>(2.0 * sqrt(fullArea / CV_PI))));
+		found++;
+	}
+
+	// report number of blobs found
+	return found;
+}
+
+// Changes the pixel stride (sample every nth row and column)
+void BlobTracker::setStride(const int sampleStride) {
+
+	// store stride, scratch regrows on the next detect if it needs to
+	stride = (sampleStride > 0) ? sampleStride : 1;
+}
+
+// Reports how many times scratch memory had to grow since construction
+unsigned long BlobTracker::getAllocationCount() {
+
+	// report running total
+	return allocationCount;
+}
+
+// Finds the root label of a run (union-find with path halving)
+int BlobTracker::findRoot(int label) {
+
+	// walk to the root, pointing nodes at their grandparents along the way
+	while (parent[label] != label) {
+		parent[label] = parent[parent[label]];
+		label = parent[label];
+	}
+
+	// report root
+	return label;
+}
+
+// Reserves room in every scratch vector for the given sampled columns, rows and runs, counts growth
+void BlobTracker::reserveScratch(const size_t columns, const size_t rows, const size_t maxRuns) {
+
+	// grow row mask if region is wider than any before
+	if (rowMask.size() < columns) {
+		rowMask.resize(columns);
+		allocationCount++;
+	}
+
+	// grow row index if region is taller than any before
+	if (rowStarts.capacity() < rows) {
+		rowStarts.reserve(rows);
+		allocationCount++;
+	}
+
+	// grow run storage if region could hold more runs than any before
+	if (runs.capacity() < maxRuns) {
+		runs.reserve(maxRuns);
+		parent.reserve(maxRuns);
+		area.reserve(maxRuns);
+		sumX.reserve(maxRuns);
+		sumY.reserve(maxRuns);
+		minX.reserve(maxRuns);
+		maxX.reserve(maxRuns);
+		minY.reserve(maxRuns);
+		maxY.reserve(maxRuns);
+		allocationCount++;
+	}
+}
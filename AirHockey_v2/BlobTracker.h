@@ -0,0 +1,61 @@
+#pragma once
+#include "GameData.h"
+#include <climits>
+
+// Bright blob tracker, thresholds and labels IR flares in one pass over a frame region
+// Flares are treated as dilated by a radius: runs within twice it join one blob and areas count the dilated size, without dilating the frame
+class BlobTracker {
+public:
+
+	// Constructor, sets brightness threshold, blob area limits and dilation radius (full-resolution pixels) and pixel stride
+	BlobTracker(const int, const int, const int, const int, const int);
+
+	// Finds bright blobs inside a region of the frame, appends their centroids to points, returns number found
+	int detect(const cv::Mat&, const cv::Rect&, std::vector<cv::KeyPoint>&);
+
+	// Changes the pixel stride (sample every nth row and column)
+	void setStride(const int);
+
+	// Reports how many times scratch memory had to grow since construction
+	unsigned long getAllocationCount();
+
+private:
+
+	// Horizontal run of bright pixels within one sampled row
+	struct Run {
+		int row;		// full-resolution row
+		int start;		// first sampled column index in run
+		int end;		// one past last sampled column index in run
+	};
+
+	// Finds the root label of a run (union-find with path halving)
+	int findRoot(int);
+
+	// Reserves room in every scratch vector for the given sampled columns, rows and runs, counts growth
+	void reserveScratch(const size_t, const size_t, const size_t);
+
+	// brightness above which a pixel is part of a flare
+	int brightnessThreshold;
+
+	// accepted blob areas in full-resolution pixels (after dilation)
+	int minArea;
+	int maxArea;
+
+	// radius (full-resolution pixels) blobs are dilated by
+	int dilation;
+
+	// sample every nth row and column
+	int stride;
+
+	// scratch storage reused between frames
+	std::vector<unsigned char> rowMask;
+	std::vector<Run> runs;
+	std::vector<size_t> rowStarts;
+	std::vector<size_t> cursors;
+	std::vector<int> parent;
+	std::vector<double> area, sumX, sumY;
+	std::vector<int> minX, maxX, minY, maxY;
+
+	// number of times scratch memory grew
+	unsigned long allocationCount;
+};
@@ -0,0 +1,393 @@
+#include "CameraCalibration.h"
+
+using namespace cv;
+
+// Constructor, uncalibrated
+CameraCalibration::CameraCalibration() {
+
+	// no fit yet, identity lens and homography
+	calibrated = false;
+	setFrame(1, 1);
+	k1 = 0;
+	k2 = 0;
+	for (int i = 0; i < 9; i++)
+		homography[i] = (i % 4 == 0) ? 1.0 : 0.0;
+	invertHomography();
+	error = 0;
+}
+
+// Reports whether a fit has been solved or loaded
+bool CameraCalibration::isCalibrated() {
+
+	// report flag
+	return calibrated;
+}
+
+// Fits lens distortion and homography to matched sensor and projected image points from a frame of the given size, returns false if too few or degenerate
+bool CameraCalibration::solve(const std::vector<Point2f>& sensorPoints, const std::vector<Vec2>& projectedPoints, const int width, const int height) {
+
+	// forget any previous fit
+	calibrated = false;
+
+	// check there are enough pairs to fix the homography (8) and lens (2) parameters with redundancy
+	const int count = static_cast<int>(sensorPoints.size());
+	if (count != static_cast<int>(projectedPoints.size()) || count < CALIBRATION_MIN_POINTS)
+		return false;
+
+	// normalize the lens model on this frame, start from no distortion
+	setFrame(width, height);
+	k1 = 0;
+	k2 = 0;
+
+	// center and scale projected points for a well-conditioned linear fit (mean distance sqrt(2) from their centroid)
+	Vec2 mean;
+	for (int i = 0; i < count; i++)
+		mean += projectedPoints[i] / count;
+	double spread = 0;
+	for (int i = 0; i < count; i++)
+		spread += (projectedPoints[i] - mean).length() / count;
+	if (spread <= 0)
+		return false;
+	const double normalize = std::sqrt(2.0) / spread;
+
+	// accumulate normal equations of the direct linear fit (homography with last entry 1)
+	double normal[64] = {};
+	double rhs[8] = {};
+	for (int i = 0; i < count; i++) {
+
+		// build both rows of this pair's equations
+		Vec2 u = undistort(sensorPoints[i]);
+		Vec2 p = (projectedPoints[i] - mean) * normalize;
+		const double rows[2][8] = { { u.x, u.y, 1, 0, 0, 0, -u.x * p.x, -u.y * p.x }, { 0, 0, 0, u.x, u.y, 1, -u.x * p.y, -u.y * p.y } };
+		const double values[2] = { p.x, p.y };
+
+		// add rows to the normal equations
+		for (int r = 0; r < 2; r++)
+			for (int j = 0; j < 8; j++) {
+				rhs[j] += rows[r][j] * values[r];
+				for (int k = 0; k < 8; k++)
+					normal[j * 8 + k] += rows[r][j] * rows[r][k];
+			}
+	}
+
+	// solve linear fit, check points aren't degenerate (collinear or coincident)
+	if (!solveLinear(normal, rhs, 8))
+		return false;
+
+	// undo the projected point normalization
+	for (int j = 0; j < 3; j++) {
+		double last = (j < 2) ? rhs[6 + j] : 1.0;
+		homography[j] = rhs[j] / normalize + mean.x * last;
+		homography[3 + j] = rhs[3 + j] / normalize + mean.y * last;
+		homography[6 + j] = last;
+	}
+
+	// parameters refined together: lens coefficients then the homography's free entries
+	double* parameters[10] = { &k1, &k2, &homography[0], &homography[1], &homography[2], &homography[3], &homography[4], &homography[5], &homography[6], &homography[7] };
+
+	// refine lens and homography together from the linear fit (Levenberg-Marquardt, damping scaled by the curvature diagonal)
+	double cost = squaredError(sensorPoints, projectedPoints);
+	double damping = 1e-3;
+	for (int iteration = 0; iteration < CALIBRATION_MAX_ITERATIONS && cost > 0; iteration++) {
+
+		// accumulate Gauss-Newton normal equations from the analytic Jacobian
+		double curvature[100] = {};
+		double gradient[10] = {};
+		for (int i = 0; i < count; i++) {
+
+			// map point, keeping the intermediate terms the derivatives need
+			Vec2 e = (Vec2(sensorPoints[i].x, sensorPoints[i].y) - frame_center) / frame_scale;
+			double r2 = e.lengthSquared();
+			Vec2 u = undistort(sensorPoints[i]);
+			double w = homography[6] * u.x + homography[7] * u.y + 1;
+			Vec2 p = project(u);
+			Vec2 residual = p - projectedPoints[i];
+
+			// derivatives of the projected point with respect to the undistorted point
+			double dxdu = (homography[0] - p.x * homography[6]) / w;
+			double dxdv = (homography[1] - p.x * homography[7]) / w;
+			double dydu = (homography[3] - p.y * homography[6]) / w;
+			double dydv = (homography[4] - p.y * homography[7]) / w;
+
+			// Jacobian rows for both residual components
+			const double rows[2][10] = {
+				{ (dxdu * e.x + dxdv * e.y) * r2, (dxdu * e.x + dxdv * e.y) * r2 * r2, u.x / w, u.y / w, 1 / w, 0, 0, 0, -p.x * u.x / w, -p.x * u.y / w },
+				{ (dydu * e.x + dydv * e.y) * r2, (dydu * e.x + dydv * e.y) * r2 * r2, 0, 0, 0, u.x / w, u.y / w, 1 / w, -p.y * u.x / w, -p.y * u.y / w } };
+			const double values[2] = { residual.x, residual.y };
+
+			// add rows to the normal equations
+			for (int r = 0; r < 2; r++)
+				for (int j = 0; j < 10; j++) {
+					gradient[j] += rows[r][j] * values[r];
+					for (int k = 0; k < 10; k++)
+						curvature[j * 10 + k] += rows[r][j] * rows[r][k];
+				}
+		}
+
+		// raise damping until a step lowers the error, or give up once steps are negligible
+		bool improved = false;
+		while (!improved && damping < 1e10) {
+
+			// build damped system for the step
+			double system[100];
+			double step[10];
+			for (int j = 0; j < 100; j++)
+				system[j] = curvature[j];
+			for (int j = 0; j < 10; j++) {
+				system[j * 10 + j] *= 1 + damping;
+				step[j] = -gradient[j];
+			}
+
+			// check step is solvable, otherwise damp harder
+			if (!solveLinear(system, step, 10)) {
+				damping *= 10;
+				continue;
+			}
+
+			// try step, keeping the current parameters to fall back to
+			double previous[10];
+			for (int j = 0; j < 10; j++) {
+				previous[j] = *parameters[j];
+				*parameters[j] += step[j];
+			}
+			double trialCost = squaredError(sensorPoints, projectedPoints);
+
+			// check if step lowered the error, accept it and trust the model more
+			if (trialCost < cost) {
+				improved = true;
+				damping /= 10;
+
+				// check if error has converged
+				if (cost - trialCost < 1e-12 * cost)
+					iteration = CALIBRATION_MAX_ITERATIONS;
+				cost = trialCost;
+			}
+
+			// otherwise undo step and damp harder
+			else {
+				for (int j = 0; j < 10; j++)
+					*parameters[j] = previous[j];
+				damping *= 10;
+			}
+		}
+
+		// check if no step helps, fit is as good as it gets
+		if (!improved)
+			break;
+	}
+
+	// record RMS error, fit is usable once it can be inverted
+	error = std::sqrt(cost / count);
+	calibrated = invertHomography();
+	return calibrated;
+}
+
+// Reports the RMS distance (projected image pixels) between the fitted and measured points
+double CameraCalibration::getError() {
+
+	// report fit error
+	return error;
+}
+
+// Converts a sensor-space point to projected image space
+Vec2 CameraCalibration::toProjection(const Point2f& point) {
+
+	// undo lens distortion, then map onto the projected image
+	return project(undistort(point));
+}
+
+// Converts a projected image point to sensor space
+Point2f CameraCalibration::toSensor(const Vec2& point) {
+
+	// map back through the inverse homography to undistorted camera coordinates
+	double w = inverseHomography[6] * point.x + inverseHomography[7] * point.y + inverseHomography[8];
+	Vec2 u((inverseHomography[0] * point.x + inverseHomography[1] * point.y + inverseHomography[2]) / w, (inverseHomography[3] * point.x + inverseHomography[4] * point.y + inverseHomography[5]) / w);
+
+	// re-apply lens distortion by fixed-point iteration (the radial factor stays near 1 across the frame)
+	Vec2 e = u;
+	for (int i = 0; i < CALIBRATION_INVERSE_ITERATIONS; i++) {
+		double r2 = e.lengthSquared();
+		e = u / (1 + k1 * r2 + k2 * r2 * r2);
+	}
+
+	// convert normalized camera coordinates back to sensor pixels
+	Vec2 sensor = frame_center + e * frame_scale;
+	return Point2f(static_cast<float>(sensor.x), static_cast<float>(sensor.y));
+}
+
+// Writes the fit to a file, returns false if it can't be written
+bool CameraCalibration::save(const std::string& path) {
+
+	// open file, replacing any older fit
+	std::ofstream file(path.c_str(), std::ios::binary | std::ios::trunc);
+
+	// write fit, report whether every write succeeded
+	return write(file);
+}
+
+// Writes the fit to a stream (a calibration file or a recording header), returns false if it can't be written
+bool CameraCalibration::write(std::ostream& stream) {
+
+	// write magic, version, frame size and fit
+	const uint32_t version = CALIBRATION_VERSION;
+	const int32_t size[2] = { frame_width, frame_height };
+	stream.write(CALIBRATION_MAGIC, 4);
+	stream.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	stream.write(reinterpret_cast<const char*>(size), sizeof(size));
+	stream.write(reinterpret_cast<const char*>(&k1), sizeof(k1));
+	stream.write(reinterpret_cast<const char*>(&k2), sizeof(k2));
+	stream.write(reinterpret_cast<const char*>(homography), sizeof(homography));
+	stream.write(reinterpret_cast<const char*>(&error), sizeof(error));
+
+	// report whether every write succeeded
+	return stream.good();
+}
+
+// Reads a fit from a file, returns false if it's missing, unrecognized or for another frame size
+bool CameraCalibration::load(const std::string& path, const int width, const int height) {
+
+	// open file
+	std::ifstream file(path.c_str(), std::ios::binary);
+
+	// read fit, report whether it can be used
+	return read(file, width, height);
+}
+
+// Reads a fit from a stream (a calibration file or a recording header), returns false if it's truncated, unrecognized or for another frame size
+bool CameraCalibration::read(std::istream& stream, const int width, const int height) {
+
+	// read magic, version, frame size and fit into temporaries
+	char magic[4] = {};
+	uint32_t version = 0;
+	int32_t size[2] = {};
+	double coefficients[2] = {};
+	double matrix[9] = {};
+	double fitError = 0;
+	stream.read(magic, 4);
+	stream.read(reinterpret_cast<char*>(&version), sizeof(version));
+	stream.read(reinterpret_cast<char*>(size), sizeof(size));
+	stream.read(reinterpret_cast<char*>(coefficients), sizeof(coefficients));
+	stream.read(reinterpret_cast<char*>(matrix), sizeof(matrix));
+	stream.read(reinterpret_cast<char*>(&fitError), sizeof(fitError));
+
+	// check fit is complete, recognized and was fitted at this frame size (the lens model is normalized on it)
+	if (!stream.good() || memcmp(magic, CALIBRATION_MAGIC, 4) != 0 || version != CALIBRATION_VERSION || size[0] != width || size[1] != height)
+		return false;
+
+	// adopt fit
+	setFrame(width, height);
+	k1 = coefficients[0];
+	k2 = coefficients[1];
+	for (int i = 0; i < 9; i++)
+		homography[i] = matrix[i];
+	error = fitError;
+
+	// fit is usable once it can be inverted
+	calibrated = invertHomography();
+	return calibrated;
+}
+
+// Sets the frame the lens model is centered and normalized on
+void CameraCalibration::setFrame(const int width, const int height) {
+
+	// remember size, center on the frame, normalize corners to unit distance
+	frame_width = width;
+	frame_height = height;
+	frame_center = Vec2(width / 2.0, height / 2.0);
+	frame_scale = frame_center.length();
+}
+
+// Converts a sensor-space point to normalized, undistorted camera coordinates
+Vec2 CameraCalibration::undistort(const Point2f& point) {
+
+	// normalize about the frame center
+	Vec2 e = (Vec2(point.x, point.y) - frame_center) / frame_scale;
+
+	// scale radially by the lens model
+	double r2 = e.lengthSquared();
+	return e * (1 + k1 * r2 + k2 * r2 * r2);
+}
+
+// Applies the homography to an undistorted point
+Vec2 CameraCalibration::project(const Vec2& u) {
+
+	// multiply out and divide by the homogeneous coordinate
+	double w = homography[6] * u.x + homography[7] * u.y + homography[8];
+	return Vec2((homography[0] * u.x + homography[1] * u.y + homography[2]) / w, (homography[3] * u.x + homography[4] * u.y + homography[5]) / w);
+}
+
+// Sums the squared distances (projected image pixels) between the mapped sensor points and their measured projected points
+double CameraCalibration::squaredError(const std::vector<Point2f>& sensorPoints, const std::vector<Vec2>& projectedPoints) {
+
+	// accumulate over every pair
+	double total = 0;
+	for (size_t i = 0; i < sensorPoints.size(); i++)
+		total += (toProjection(sensorPoints[i]) - projectedPoints[i]).lengthSquared();
+	return total;
+}
+
+// Inverts the homography, returns false if it's singular
+bool CameraCalibration::invertHomography() {
+
+	// alias entries
+	const double* h = homography;
+
+	// calculate adjugate (transposed cofactors)
+	double adjugate[9] = {
+		h[4] * h[8] - h[5] * h[7], h[2] * h[7] - h[1] * h[8], h[1] * h[5] - h[2] * h[4],
+		h[5] * h[6] - h[3] * h[8], h[0] * h[8] - h[2] * h[6], h[2] * h[3] - h[0] * h[5],
+		h[3] * h[7] - h[4] * h[6], h[1] * h[6] - h[0] * h[7], h[0] * h[4] - h[1] * h[3] };
+
+	// check determinant, a singular homography can't be inverted
+	double determinant = h[0] * adjugate[0] + h[1] * adjugate[3] + h[2] * adjugate[6];
+	if (determinant == 0 || !std::isfinite(determinant))
+		return false;
+
+	// scale adjugate into the inverse
+	for (int i = 0; i < 9; i++)
+		inverseHomography[i] = adjugate[i] / determinant;
+	return true;
+}
+
+// Solves a small dense linear system in place (row-major matrix, right-hand side becomes the solution), returns false if singular
+bool CameraCalibration::solveLinear(double* matrix, double* values, const int size) {
+
+	// eliminate below the diagonal column by column
+	for (int column = 0; column < size; column++) {
+
+		// pick the largest remaining pivot for stability
+		int pivot = column;
+		for (int row = column + 1; row < size; row++)
+			if (std::abs(matrix[row * size + column]) > std::abs(matrix[pivot * size + column]))
+				pivot = row;
+
+		// check pivot is usable
+		if (!(std::abs(matrix[pivot * size + column]) > 1e-300))
+			return false;
+
+		// swap pivot row into place
+		if (pivot != column) {
+			for (int k = 0; k < size; k++)
+				std::swap(matrix[pivot * size + k], matrix[column * size + k]);
+			std::swap(values[pivot], values[column]);
+		}
+
+		// clear column below pivot
+		for (int row = column + 1; row < size; row++) {
+			double factor = matrix[row * size + column] / matrix[column * size + column];
+			for (int k = column; k < size; k++)
+				matrix[row * size + k] -= factor * matrix[column * size + k];
+			values[row] -= factor * values[column];
+		}
+	}
+
+	// substitute back from the last row
+	for (int row = size - 1; row >= 0; row--) {
+		for (int k = row + 1; k < size; k++)
+			values[row] -= matrix[row * size + k] * values[k];
+		values[row] /= matrix[row * size + row];
+	}
+
+	// report solution found
+	return true;
+}
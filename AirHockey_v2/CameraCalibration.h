@@ -0,0 +1,79 @@
+#pragma once
+#include "GameData.h"
+#include <vector>
+
+// Camera-to-projection calibration, maps sensor pixels to projected image pixels through a radial lens model and a homography
+// Applied to detected keypoints only (a handful per frame), frames are never remapped
+class CameraCalibration {
+public:
+
+	// Constructor, uncalibrated
+	CameraCalibration();
+
+	// Reports whether a fit has been solved or loaded
+	bool isCalibrated();
+
+	// Fits lens distortion and homography to matched sensor and projected image points from a frame of the given size, returns false if too few or degenerate
+	bool solve(const std::vector<cv::Point2f>&, const std::vector<Vec2>&, const int, const int);
+
+	// Reports the RMS distance (projected image pixels) between the fitted and measured points
+	double getError();
+
+	// Converts a sensor-space point to projected image space
+	Vec2 toProjection(const cv::Point2f&);
+
+	// Converts a projected image point to sensor space
+	cv::Point2f toSensor(const Vec2&);
+
+	// Writes the fit to a file, returns false if it can't be written
+	bool save(const std::string&);
+
+	// Reads a fit from a file, returns false if it's missing, unrecognized or for another frame size
+	bool load(const std::string&, const int, const int);
+
+	// Writes the fit to a stream (a calibration file or a recording header), returns false if it can't be written
+	bool write(std::ostream&);
+
+	// Reads a fit from a stream (a calibration file or a recording header), returns false if it's truncated, unrecognized or for another frame size
+	bool read(std::istream&, const int, const int);
+
+private:
+
+	// Sets the frame the lens model is centered and normalized on
+	void setFrame(const int, const int);
+
+	// Converts a sensor-space point to normalized, undistorted camera coordinates
+	Vec2 undistort(const cv::Point2f&);
+
+	// Applies the homography to an undistorted point
+	Vec2 project(const Vec2&);
+
+	// Sums the squared distances (projected image pixels) between the mapped sensor points and their measured projected points
+	double squaredError(const std::vector<cv::Point2f>&, const std::vector<Vec2>&);
+
+	// Inverts the homography, returns false if it's singular
+	bool invertHomography();
+
+	// Solves a small dense linear system in place (row-major matrix, right-hand side becomes the solution), returns false if singular
+	static bool solveLinear(double*, double*, const int);
+
+	// flag for a solved or loaded fit
+	bool calibrated;
+
+	// frame size, center and half-diagonal (sensor pixels) the lens model is normalized on
+	int frame_width;
+	int frame_height;
+	Vec2 frame_center;
+	double frame_scale;
+
+	// radial distortion coefficients (r^2 and r^4 terms)
+	double k1;
+	double k2;
+
+	// homography from undistorted camera coordinates to projected image pixels (row-major, last entry 1) and its inverse
+	double homography[9];
+	double inverseHomography[9];
+
+	// RMS fit error (projected image pixels)
+	double error;
+};
@@ -0,0 +1,82 @@
+#include "FrameQueue.h"
+
+// Constructor, no slots allocated yet
+FrameQueue::FrameQueue() : writeIndex(0), readyIndex(1), readIndex(2), readyFresh(false), droppedFrames(0), processedFrames(0) {
+}
+
+// Sizes every slot like the given frame so steady-state captures never allocate
+void FrameQueue::allocateSlots(const cv::Mat& prototype) {
+
+	// give each slot its own buffer of the frame's size and type
+	for (int i = 0; i < SENSOR_FRAME_SLOTS; i++)
+		slots[i].create(prototype.rows, prototype.cols, prototype.type());
+}
+
+// Returns the slot the capture thread should fill next
+cv::Mat& FrameQueue::writeSlot() {
+
+	// write slot belongs to capture until it's published, no lock needed
+	return slots[writeIndex];
+}
+
+// Publishes the filled slot as the newest frame, replacing (dropping) any frame not yet taken
+void FrameQueue::publish(const std::chrono::steady_clock::time_point captureTime) {
+
+	// stamp frame before it becomes visible
+	captureTimes[writeIndex] = captureTime;
+
+	// flag for an untaken frame being replaced
+	bool dropped;
+	{
+		// swap filled slot with the ready slot
+		std::lock_guard<std::mutex> lock(slotLock);
+		std::swap(writeIndex, readyIndex);
+		dropped = readyFresh;
+		readyFresh = true;
+	}
+
+	// count the replaced frame
+	if (dropped)
+		droppedFrames++;
+
+	// wake processing
+	frameReady.notify_one();
+}
+
+// Waits (up to the given time in ms, 0 doesn't wait) for a frame newer than the last one taken, returns false if none arrived
+bool FrameQueue::takeLatest(const cv::Mat*& frame, std::chrono::steady_clock::time_point& captureTime, const int wait_ms) {
+	{
+		// wait for a fresh frame, give up after the timeout so the caller can check for shutdown
+		std::unique_lock<std::mutex> lock(slotLock);
+		if (!frameReady.wait_for(lock, std::chrono::milliseconds(wait_ms), [this] { return readyFresh; }))
+			return false;
+
+		// swap the finished read slot with the ready slot
+		std::swap(readIndex, readyIndex);
+		readyFresh = false;
+	}
+
+	// hand read slot to processing, it stays untouched until the next take
+	frame = &slots[readIndex];
+	captureTime = captureTimes[readIndex];
+
+	// count the taken frame
+	processedFrames++;
+
+	// report success
+	return true;
+}
+
+// Reports how many captured frames were replaced before processing took them
+unsigned long FrameQueue::getDroppedCount() {
+
+	// report running total
+	return droppedFrames.load();
+}
+
+// Reports how many captured frames were handed to processing
+unsigned long FrameQueue::getProcessedCount() {
+
+	// report running total
+	return processedFrames.load();
+}
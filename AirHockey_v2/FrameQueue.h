@@ -0,0 +1,53 @@
+#pragma once
+#include "GameData.h"
+
+// Latest-frame queue between the capture and processing threads, backed by a fixed pool of frame slots
+// The writer always owns one slot, the reader owns another, and the newest finished frame waits in the third
+class FrameQueue {
+public:
+
+	// Constructor, no slots allocated yet
+	FrameQueue();
+
+	// Sizes every slot like the given frame so steady-state captures never allocate
+	void allocateSlots(const cv::Mat&);
+
+	// Returns the slot the capture thread should fill next
+	cv::Mat& writeSlot();
+
+	// Publishes the filled slot as the newest frame, replacing (dropping) any frame not yet taken
+	void publish(const std::chrono::steady_clock::time_point);
+
+	// Waits (up to the given time in ms, 0 doesn't wait) for a frame newer than the last one taken, returns false if none arrived
+	bool takeLatest(const cv::Mat*&, std::chrono::steady_clock::time_point&, const int);
+
+	// Reports how many captured frames were replaced before processing took them
+	unsigned long getDroppedCount();
+
+	// Reports how many captured frames were handed to processing
+	unsigned long getProcessedCount();
+
+private:
+
+	// frame slots and the time each one was captured
+	cv::Mat slots[SENSOR_FRAME_SLOTS];
+	std::chrono::steady_clock::time_point captureTimes[SENSOR_FRAME_SLOTS];
+
+	// slot owned by capture, slot holding the newest frame, slot owned by processing
+	int writeIndex;
+	int readyIndex;
+	int readIndex;
+
+	// flag for a ready frame processing hasn't taken yet
+	bool readyFresh;
+
+	// guards the slot indices (held only to swap them, never while copying pixels)
+	std::mutex slotLock;
+
+	// wakes processing when a new frame is published
+	std::condition_variable frameReady;
+
+	// frame counters, readable from any thread
+	std::atomic<unsigned long> droppedFrames;
+	std::atomic<unsigned long> processedFrames;
+};
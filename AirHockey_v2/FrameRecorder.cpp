@@ -0,0 +1,73 @@
+#include "FrameRecorder.h"
+
+// Constructor, opens the recording file, keeping the camera calibration the frames are mapped with (header is written with the first frame)
+FrameRecorder::FrameRecorder(const std::string& path, const CameraCalibration& cameraCalibration) : file(path.c_str(), std::ios::binary | std::ios::trunc), calibration(cameraCalibration) {
+
+	// format unknown until the first frame
+	rows = 0;
+	cols = 0;
+	type = 0;
+
+	// nothing written yet
+	frameCount = 0;
+}
+
+// Reports whether the file opened and all writes so far succeeded
+bool FrameRecorder::isOpen() {
+
+	// report stream health
+	return file.good();
+}
+
+// Appends a frame and its capture time, returns false on a write failure or a frame format change
+bool FrameRecorder::writeFrame(const cv::Mat& frame, const std::chrono::steady_clock::time_point captureTime) {
+
+	// check if the stream is usable and the frame has pixels
+	if (!file.good() || frame.empty())
+		return false;
+
+	// check if this is the first frame, fix the format and write the header
+	if (frameCount == 0) {
+		rows = frame.rows;
+		cols = frame.cols;
+		type = frame.type();
+		const uint32_t version = RECORDING_VERSION;
+		file.write(RECORDING_MAGIC, 4);
+		file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+		file.write(reinterpret_cast<const char*>(&rows), sizeof(rows));
+		file.write(reinterpret_cast<const char*>(&cols), sizeof(cols));
+		file.write(reinterpret_cast<const char*>(&type), sizeof(type));
+
+		// write calibration, if the camera has one
+		const int32_t calibrated = calibration.isCalibrated() ? 1 : 0;
+		file.write(reinterpret_cast<const char*>(&calibrated), sizeof(calibrated));
+		if (calibrated)
+			calibration.write(file);
+	}
+
+	// check if the frame format changed mid-recording (can't be replayed)
+	else if (frame.rows != rows || frame.cols != cols || frame.type() != type)
+		return false;
+
+	// write capture time in nanoseconds
+	const int64_t captureTime_ns = std::chrono::duration_cast<std::chrono::nanoseconds>(captureTime.time_since_epoch()).count();
+	file.write(reinterpret_cast<const char*>(&captureTime_ns), sizeof(captureTime_ns));
+
+	// write pixels row by row (frame may not be continuous)
+	const std::streamsize rowBytes = static_cast<std::streamsize>(cols * frame.elemSize());
+	for (int y = 0; y < rows; y++)
+		file.write(reinterpret_cast<const char*>(frame.ptr(y)), rowBytes);
+
+	// count frame
+	frameCount++;
+
+	// report write success
+	return file.good();
+}
+
+// Reports how many frames were written
+unsigned long FrameRecorder::getFrameCount() {
+
+	// report running total
+	return frameCount;
+}
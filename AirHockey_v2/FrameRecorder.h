@@ -0,0 +1,38 @@
+#pragma once
+#include "GameData.h"
+#include "CameraCalibration.h"
+
+// Writes raw sensor frames and their capture times to a binary recording
+// Layout: "AHRF", uint32 version, int32 rows, cols, type, int32 calibrated flag (followed by the calibration, as saved to file, if set),
+// then per frame an int64 capture time (ns) and rows*cols*elemSize bytes
+class FrameRecorder {
+public:
+
+	// Constructor, opens the recording file, keeping the camera calibration the frames are mapped with (header is written with the first frame)
+	FrameRecorder(const std::string&, const CameraCalibration& = CameraCalibration());
+
+	// Reports whether the file opened and all writes so far succeeded
+	bool isOpen();
+
+	// Appends a frame and its capture time, returns false on a write failure or a frame format change
+	bool writeFrame(const cv::Mat&, const std::chrono::steady_clock::time_point);
+
+	// Reports how many frames were written
+	unsigned long getFrameCount();
+
+private:
+
+	// recording output stream
+	std::ofstream file;
+
+	// format of the recorded frames (fixed by the first frame)
+	int rows;
+	int cols;
+	int type;
+
+	// camera calibration stored in the header so replays map detections the same way
+	CameraCalibration calibration;
+
+	// number of frames written
+	unsigned long frameCount;
+};
@@ -0,0 +1,118 @@
+#include "FrameReplay.h"
+
+// Constructor, opens the recording and reads its header
+FrameReplay::FrameReplay(const std::string& path) : file(path.c_str(), std::ios::binary) {
+
+	// format unknown until header is read
+	rows = 0;
+	cols = 0;
+	type = 0;
+
+	// read magic, version and frame format
+	char magic[4] = {};
+	uint32_t version = 0;
+	file.read(magic, 4);
+	file.read(reinterpret_cast<char*>(&version), sizeof(version));
+	file.read(reinterpret_cast<char*>(&rows), sizeof(rows));
+	file.read(reinterpret_cast<char*>(&cols), sizeof(cols));
+	file.read(reinterpret_cast<char*>(&type), sizeof(type));
+
+	// check header is complete and recognized (version 1 recordings predate stored calibrations)
+	valid = file.good() && memcmp(magic, RECORDING_MAGIC, 4) == 0 && (version == 1 || version == RECORDING_VERSION) && rows > 0 && cols > 0;
+
+	// read the calibration the frames were mapped with, if the recording stores one
+	int32_t calibrated = 0;
+	if (valid && version == RECORDING_VERSION) {
+		file.read(reinterpret_cast<char*>(&calibrated), sizeof(calibrated));
+		valid = file.good() && (calibrated == 0 || calibration.read(file, cols, rows));
+	}
+
+	// remember where frames start for rewinding
+	firstFrameOffset = valid ? static_cast<std::streamoff>(file.tellg()) : 0;
+
+	// peek at the first frame's capture time, replays count from it so they don't depend on the recording machine's clock
+	firstCaptureTime_ns = 0;
+	if (valid) {
+		file.read(reinterpret_cast<char*>(&firstCaptureTime_ns), sizeof(firstCaptureTime_ns));
+		file.clear();
+		file.seekg(firstFrameOffset);
+	}
+}
+
+// Reports whether the file opened with a valid header
+bool FrameReplay::isOpen() {
+
+	// report header validity
+	return valid;
+}
+
+// Reads the next frame and its capture time (relative to the first frame's), returns false at the end of the recording
+bool FrameReplay::readFrame(cv::Mat& frame, std::chrono::steady_clock::time_point& captureTime) {
+
+	// check if there is anything to read
+	if (!valid)
+		return false;
+
+	// read capture time, stop cleanly at end of file
+	int64_t captureTime_ns = 0;
+	if (!file.read(reinterpret_cast<char*>(&captureTime_ns), sizeof(captureTime_ns)))
+		return false;
+
+	// make sure frame has the recorded format (no-op once sized)
+	frame.create(rows, cols, type);
+
+	// read pixels row by row, a truncated frame ends the replay
+	const std::streamsize rowBytes = static_cast<std::streamsize>(cols * frame.elemSize());
+	for (int y = 0; y < rows; y++)
+		if (!file.read(reinterpret_cast<char*>(frame.ptr(y)), rowBytes))
+			return false;
+
+	// restore capture time, counted from the first frame
+	captureTime = std::chrono::steady_clock::time_point(std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::nanoseconds(captureTime_ns - firstCaptureTime_ns)));
+
+	// report success
+	return true;
+}
+
+// Restarts reading at the first frame, returns false if the recording isn't valid
+bool FrameReplay::rewind() {
+
+	// check if there is anything to rewind
+	if (!valid)
+		return false;
+
+	// clear end-of-file state and seek back to the first frame
+	file.clear();
+	file.seekg(firstFrameOffset);
+
+	// report seek success
+	return file.good();
+}
+
+// Reports the recorded frame rows
+int FrameReplay::getRows() {
+
+	// report format
+	return rows;
+}
+
+// Reports the recorded frame columns
+int FrameReplay::getCols() {
+
+	// report format
+	return cols;
+}
+
+// Reports the recorded frame type
+int FrameReplay::getType() {
+
+	// report format
+	return type;
+}
+
+// Reports the camera calibration the recording was made with (uncalibrated if it had none)
+CameraCalibration FrameReplay::getCalibration() {
+
+	// report stored calibration
+	return calibration;
+}
@@ -0,0 +1,54 @@
+#pragma once
+#include "GameData.h"
+#include "CameraCalibration.h"
+
+// Reads frames and capture times back from a FrameRecorder recording, in order and as fast as asked
+class FrameReplay {
+public:
+
+	// Constructor, opens the recording and reads its header
+	FrameReplay(const std::string&);
+
+	// Reports whether the file opened with a valid header
+	bool isOpen();
+
+	// Reads the next frame and its capture time (relative to the first frame's), returns false at the end of the recording
+	bool readFrame(cv::Mat&, std::chrono::steady_clock::time_point&);
+
+	// Restarts reading at the first frame, returns false if the recording isn't valid
+	bool rewind();
+
+	// Reports the recorded frame rows
+	int getRows();
+
+	// Reports the recorded frame columns
+	int getCols();
+
+	// Reports the recorded frame type
+	int getType();
+
+	// Reports the camera calibration the recording was made with (uncalibrated if it had none)
+	CameraCalibration getCalibration();
+
+private:
+
+	// recording input stream
+	std::ifstream file;
+
+	// format of the recorded frames
+	int rows;
+	int cols;
+	int type;
+
+	// camera calibration the recording was made with
+	CameraCalibration calibration;
+
+	// flag for a valid header
+	bool valid;
+
+	// file offset of the first frame
+	std::streamoff firstFrameOffset;
+
+	// recorded capture time (ns) of the first frame, subtracted from every replayed capture time
+	int64_t firstCaptureTime_ns;
+};
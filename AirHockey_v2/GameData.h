@@ -2,18 +2,21 @@
 #include <chrono>
 #include <thread>
 #include <mutex>
+#include <condition_variable>
+#include <atomic>
 #include <string>
+#include <fstream>
+#include <cstdint>
+#include <cstring>
 
-// check OS, include OpenCV headers and asset path with proper file path format
+// check OS, include headless OpenCV headers and asset path with proper file path format (windowing lives in Graphics.h)
 #ifdef _WIN32
-	#include <opencv2\highgui.hpp>
-	#include <opencv2\features2d.hpp>
+	#include <opencv2\videoio.hpp>
 	#include <opencv2\imgproc.hpp>
 	#include <opencv2\core.hpp>
 	#define ASSET_PATH "assets\\"
 #else
-	#include <opencv2/highgui.hpp>
-	#include <opencv2/features2d.hpp>
+	#include <opencv2/videoio.hpp>
 	#include <opencv2/imgproc.hpp>
 	#include <opencv2/core.hpp>
 	#define ASSET_PATH "assets//"
@@ -23,22 +26,56 @@
 // define parameters for gameplay tweaking
 #define PROJECTOR_SPREAD_HORIZ 1.0		// (width of projected image)/(distance from projector)
 #define PROJECTOR_SPREAD_VERT 2.0/3.0	// (height of projected image)/(distance from projector)
+#define PROJECTOR_DEFAULT_DISTANCE 1000.0	// projector distance assumed until the uS sensor measures it
 #define OUTPUT_IMAGE_WIDTH 1200.0		// pixelwise width of projection
 #define OUTPUT_IMAGE_HEIGHT 800.0		// pixelwise height of projection
 #define SENSOR_DOWNSAMPLE_RATIO 1		// higher for less accurate but faster blob detection
+#define SENSOR_BRIGHTNESS_THRESHOLD 240	// pixel brightness above which a pixel belongs to a flare
+#define SENSOR_MIN_BLOB_AREA 100		// smallest flare area (sensor pixels, after dilation) accepted as a paddle
+#define SENSOR_MAX_BLOB_AREA 10000		// largest flare area (sensor pixels, after dilation) accepted as a paddle
+#define SENSOR_BLOB_DILATION 5			// radius (sensor pixels) flares are dilated by, bridging gaps up to twice it (five 3x3 passes)
+#define SENSOR_TRACKING_WINDOW 240		// side length (sensor pixels) of the search window around each paddle
+#define SENSOR_FRAME_SLOTS 3			// frame slots shared by capture and processing (capture, processing and newest frame, keep at 3)
+#define SENSOR_FRAME_WAIT_MS 100		// max time (ms) processing waits for a new frame before rechecking game state
+#define SENSOR_EMPTY_GRAB_BACKOFF_MS 10	// time (ms) capture sleeps after an empty camera grab before grabbing again
+#define SENSOR_MAX_EMPTY_GRABS 100		// consecutive empty camera grabs (about a second of backoff) after which the camera counts as lost
+#define SENSOR_SYNTHETIC_WIDTH 640		// synthetic camera frame width (latency test)
+#define SENSOR_SYNTHETIC_HEIGHT 480		// synthetic camera frame height (latency test)
+#define PADDLE_FILTER_ALPHA 0.8			// share of a detection's position error applied to the paddle estimate
+#define PADDLE_FILTER_BETA 0.25			// share of a detection's position error folded into paddle velocity
+#define PADDLE_CONFIDENCE_GAIN 0.5		// fraction confidence moves toward 1 on a detection (and toward 0 on a miss)
+#define PADDLE_REACQUIRE_CONFIDENCE 0.2	// below this confidence a detection restarts the paddle filter
+#define PADDLE_COAST_DAMPING 0.5		// fraction of paddle velocity kept per frame without a detection
+#define PADDLE_MIN_CONFIDENCE 0.5		// below this confidence physics doesn't extrapolate a paddle
+#define PADDLE_MAX_EXTRAPOLATION 0.1	// longest time (secs) a paddle estimate is projected forward to a physics step
 #define PUCK_RADIUS 25.0				// radius of puck in real-world relative units
 #define PADDLE_RADIUS 35.0				// same for paddles
 #define WALL_PADDING_THICKNESS 18.0		// use to account for padding in bg image
 #define GOAL_WIDTH 150.0				// width in real-world relative units
 #define PUCK_MAX_VELOCITY 1e9			// threshold to catch unrealistic physics
 #define WALL_ELASTICITY 0.8				// coefficient of energy conserved during collision
+#define PUCK_ELASTICITY 0.9				// same for puck-puck collisions (multi-puck mode)
 #define PUCK_FRICTION 50.0				// units per sec of deceleration
 #define WINNING_SCORE 10				// score to win
-#define PHYSICS_FRAME_RATIO 100			// number of physics frames per graphics frame (increase to resolve high speed collisions)
+#define PHYSICS_FRAME_RATIO 8			// number of physics frames per graphics frame (collisions are swept, so this only sets integration accuracy)
+#define PHYSICS_MAX_SWEEP_CONTACTS 4	// max wall/paddle contacts resolved within one physics frame
+#define CONTACT_SEPARATION 1e-6			// gap left between puck and paddle after pushing them apart
+#define PHYSICS_MAX_PUCKS 64			// most pucks on the table at once (multi-puck mode)
+#define PUCK_RACK_GAP 10.0				// gap between neighbouring pucks when racked at the start
 #define GRAPHICS_TARGET_FRAMERATE 30	// target framerate for display (NOT detection)
+#define GRAPHICS_DIRTY_RECTS (PHYSICS_MAX_PUCKS + 3)	// regions restored per gameplay frame (pucks, two paddles and a score change)
+#define GRAPHICS_ASSET_COUNT 7			// imported screen and backdrop images
+#define GRAPHICS_ASSET_SPLASH 0			// index of the startup splash, imported first so it can be shown early
+#define PHYSICS_MAX_CATCHUP_FRAMES 3	// max graphics frames of physics replayed after a stall (older time is dropped)
 #define GOAL_CELEBRATION_TIME 3000		// time (ms) to display goal splash
+#define METRICS_REPORT_INTERVAL 5000	// time (ms) between latency reports
+#define LATENCY_TEST_DURATION 10000		// time (ms) the latency test runs before checking its accounting
+#define LATENCY_TEST_FRAMERATE 60.0		// synthetic camera framerate in the latency test
+#define LATENCY_TEST_DELAY_MS 20.0		// capture-to-delivery delay (ms) injected by the synthetic camera
 #define WINDOW_TITLE "Virtual Air Hockey"
 
+#include "WorldState.h"
+
 // gameplay-state flag states
 #define SETUP -1
 #define IN_PLAY 0
@@ -48,19 +85,74 @@
 #define WIN_TWO 4
 #define ERROR 5
 
-// game state flags
-extern bool game_in_play;
-extern int gameState;
+// swept contact types
+#define CONTACT_NONE 0
+#define CONTACT_WALL_VERTICAL 1
+#define CONTACT_WALL_HORIZONTAL 2
+#define CONTACT_PADDLE_ONE 3
+#define CONTACT_PADDLE_TWO 4
+
+// instrumented pipeline stages
+#define STAGE_CAPTURE 0
+#define STAGE_DETECT 1
+#define STAGE_UPDATE_PADDLES 2
+#define STAGE_TICK 3
+#define STAGE_DRAW 4
+#define STAGE_IMSHOW 5
+#define STAGE_M2P_QUEUE 6		// camera frame captured to taken by the sensor thread
+#define STAGE_M2P_SENSOR 7		// taken to paddle estimates published
+#define STAGE_M2P_PHYSICS 8		// published to first physics step using them
+#define STAGE_M2P_RENDER 9		// stepped to gameplay image drawn
+#define STAGE_M2P_PRESENT 10	// drawn to presented on screen
+#define STAGE_M2P_TOTAL 11		// captured to presented (motion-to-photon)
+#define STAGE_SENSOR_WAIT 12	// sensor task queued to started on the worker pool
+#define STAGE_PHYSICS_WAIT 13	// physics batch due to started on the worker pool
+#define STAGE_COUNT 14
+
+// latency histogram layout (16 sub-buckets per power of two, up to 2^64 ns)
+#define HISTOGRAM_SUB_BUCKET_BITS 4
+#define HISTOGRAM_SUB_BUCKETS 16
+#define HISTOGRAM_BUCKETS 976
+
+// sensor recording file format
+#define RECORDING_MAGIC "AHRF"
+#define RECORDING_VERSION 2
+
+// packed asset bundle file format
+#define ASSET_BUNDLE_NAME "assets.bundle"
+#define ASSET_BUNDLE_MAGIC "AHAB"
+#define ASSET_BUNDLE_VERSION 1
+#define ASSET_BUNDLE_ALIGNMENT 64
+#define ASSET_NAME_LENGTH 32
 
-// puck position and velocity arrays
-extern double puck_position[2], puck_velocity[2];
+// camera calibration file format and procedure (--calibrate)
+#define CALIBRATION_FILE_PREFIX "calibration_camera"	// file name is the prefix, camera index and ".bin"
+#define CALIBRATION_MAGIC "AHCC"
+#define CALIBRATION_VERSION 1
+#define CALIBRATION_GRID_COLUMNS 7				// markers across the projection
+#define CALIBRATION_GRID_ROWS 5					// markers down the projection
+#define CALIBRATION_MARGIN 0.1					// fraction of the projection between the outer markers and its edges
+#define CALIBRATION_MARKER_RADIUS 12			// radius (projector pixels) of a projected marker
+#define CALIBRATION_SETTLE_MS 300				// time (ms) a marker is shown before the frame it's detected in
+#define CALIBRATION_MIN_POINTS 8				// fewest detected markers a calibration is solved from
+#define CALIBRATION_MAX_ERROR 3.0				// largest RMS fit error (projector pixels) a calibration is accepted with
+#define CALIBRATION_MAX_ITERATIONS 100			// most Levenberg-Marquardt iterations of a calibration fit
+#define CALIBRATION_INVERSE_ITERATIONS 10		// fixed-point iterations re-applying lens distortion (projection to sensor)
 
-// paddle position and velocity arrays
-extern double paddleOne_position[2], paddleOne_velocity[2];
-extern double paddleTwo_position[2], paddleTwo_velocity[2];
+// batch simulation (headless parameter sweeps)
+#define SIMULATION_GAMES_PER_TASK 16			// games stepped by one worker pool task
+#define SIMULATION_SERVE_SPEED 600.0			// speed (units/s) the puck is served at, at the start and after each goal
+#define SIMULATION_SERVE_ANGLE 0.5				// widest angle (rad) off the table's long axis a serve leaves at
+#define SIMULATION_STALL_TIME 5.0				// time (secs) a stopped puck waits before being served again
+#define PADDLE_CONTROL_SCRIPTED 0				// paddle sweeps across its goal mouth on a fixed pattern
+#define PADDLE_CONTROL_AI 1						// paddle played by the CPU opponent
+#define PADDLE_SCRIPT_FREQUENCY 0.5				// sweeps per sec of a scripted paddle
 
-// table dimension information
-extern double table_width, table_height, table_center[2], table_centerLeft[2], table_centerRight[2];
+// CPU opponent (single-player mode and simulated games)
+#define PADDLE_AI_MAX_SPEED 1500.0				// fastest (units/s) an AI paddle moves
+#define PADDLE_AI_DEFENSE_DEPTH 3.0				// distance (paddle radii) of the AI's defence line from its end wall padding
+#define PADDLE_AI_REACTION_TIME 0.1				// time (secs) between the AI's looks at the table, it plays on its last plan meanwhile
+#define PADDLE_AI_STRIKE_TIME 0.08				// time (secs) before a shot reaches the defence line that the AI lunges into it
+#define PREDICTOR_MAX_BOUNCES 8					// most wall bounces a puck flight prediction follows
 
-// game scores
-extern int score_playerOne, score_playerTwo;
\ No newline at end of file
+#include "TableState.h"
\ No newline at end of file
@@ -4,306 +4,384 @@
 
 #include "GameHost.h"
 
-// create graphics, physics and sensor instance references
-Graphics *graphics;
-Physics *physics;
-Sensor *sensor;
-
-// Main, handles setup and spawns physics, sensor and graphics threads
-int main() {
+// Main, handles setup and spawns the worker pool, scheduler, capture, metrics and graphics threads
+int main(int argc, char** argv) {
 
 	// announce process started successfully
 	std::cout << "Starting AirHockey Version 2.0.5" << std::endl;
 
 	// record the starting time of the program
-	auto startTime = std::chrono::steady_clock::now();
+	startup_time = std::chrono::steady_clock::now();
+
+	// check for latency test mode (--latency-test), runs on synthetic camera frames and exits with the result
+	// single-player mode (--ai), the CPU opponent plays paddle two
+	// and camera calibration (--calibrate), each table's camera is fitted to its projection before play
+	bool latencyTest = false;
+	bool singlePlayer = false;
+	bool calibrateCameras = false;
+	for (int i = 1; i < argc; i++) {
+		if (std::string(argv[i]) == "--latency-test")
+			latencyTest = true;
+		else if (std::string(argv[i]) == "--ai")
+			singlePlayer = true;
+		else if (std::string(argv[i]) == "--calibrate")
+			calibrateCameras = true;
+	}
+
+	// read optional paths and settings (--record <file>, --replay <file>, --metrics-file <file>, --metrics-socket <path>, --pucks <count>, --cameras <index,index,...>)
+	std::string recordPath, replayPath, metricsFilePath, metricsSocketPath;
+	int puckCount = 1;
+	std::vector<int> cameras;
+	for (int i = 1; i + 1 < argc; i++) {
+		if (std::string(argv[i]) == "--record")
+			recordPath = argv[++i];
+		else if (std::string(argv[i]) == "--replay")
+			replayPath = argv[++i];
+		else if (std::string(argv[i]) == "--metrics-file")
+			metricsFilePath = argv[++i];
+		else if (std::string(argv[i]) == "--metrics-socket")
+			metricsSocketPath = argv[++i];
+		else if (std::string(argv[i]) == "--pucks")
+			puckCount = atoi(argv[++i]);
+		else if (std::string(argv[i]) == "--cameras") {
+
+			// one table per listed camera index
+			std::istringstream list(argv[++i]);
+			std::string index;
+			while (std::getline(list, index, ','))
+				cameras.push_back(atoi(index.c_str()));
+		}
+	}
 
-	// mark game as in play and set gameState
+	// play one table on camera 0 unless told otherwise, replays and latency tests always run one table
+	if (cameras.empty() || !replayPath.empty() || latencyTest)
+		cameras.assign(1, 0);
+
+	// mark game as in play
 	game_in_play = true;
-	setGameState(IN_PLAY);
 
-	// create sensor instance and calibrate table size
-	sensor = new Sensor(0);
-	sensor->detectProjectionSize();
-	
-	// create physics instance
-	physics = new Physics();
+	// create one game per table, each with its own state, graphics and metrics (sensor and physics come with calibration)
+	for (size_t i = 0; i < cameras.size(); i++)
+		tables.push_back(new GameTable(static_cast<int>(i)));
 
-	// create graphics instance
-	graphics = new Graphics();
+	// iterate through tables, every table reports to the same outputs (each report names its table)
+	for (size_t i = 0; i < tables.size(); i++) {
 
-	// attempt to import assets
-	if (!graphics->importResources(ASSET_PATH)) {
+		// check if metrics file was requested, open it
+		if (!metricsFilePath.empty() && !tables[i]->getMetrics().openFile(metricsFilePath))
+			std::cout << "ERROR: Can't Write Metrics File " << metricsFilePath << std::endl;
 
-		// report one or more missing asset(s)
-		std::cout << "ERROR: Asset(s) Missing, Check Directory" << std::endl;
+		// check if metrics socket was requested, open it
+		if (!metricsSocketPath.empty() && !tables[i]->getMetrics().openSocket(metricsSocketPath))
+			std::cout << "ERROR: Can't Open Metrics Socket " << metricsSocketPath << std::endl;
+	}
 
-		// terminate program with failure
-		return EXIT_FAILURE;
+	// startup runs as a small dependency graph per table: cameras and assets load on workers while the main thread opens the windows
+	// camera open and warmup (with flare detector construction), then table calibration and physics, which need the table size
+	std::vector<std::future<void>> sensorsReady;
+	for (size_t i = 0; i < tables.size(); i++) {
+		sensorsReady.push_back(std::async(std::launch::async, [&, i]() {
+
+			// create sensor instance (camera, recording or synthetic camera)
+			Sensor* sensor;
+			if (latencyTest)
+				sensor = new Sensor(tables[i]->getState(), new SyntheticFrameSource(SENSOR_SYNTHETIC_WIDTH, SENSOR_SYNTHETIC_HEIGHT, LATENCY_TEST_FRAMERATE, LATENCY_TEST_DELAY_MS));
+			else if (!replayPath.empty())
+				sensor = new Sensor(tables[i]->getState(), replayPath);
+			else
+				sensor = new Sensor(tables[i]->getState(), cameras[i]);
+
+			// calibrate table size and create physics (and the CPU opponent in single-player mode)
+			tables[i]->calibrate(sensor, puckCount, singlePlayer);
+			logStartupPhase("camera " + std::to_string(cameras[i]) + " ready");
+		}));
+	}
+
+	// check if replaying, wait for recording and run headless, skipping graphics entirely
+	if (!replayPath.empty()) {
+		sensorsReady[0].get();
+		return tables[0]->replayRecording() ? EXIT_SUCCESS : EXIT_FAILURE;
+	}
+
+	// import each table's assets on a worker, splash first so it can be shown while the rest load
+	std::vector<std::promise<bool>> splashImported(tables.size());
+	std::vector<std::future<bool>> splashReady, assetsReady;
+	for (size_t i = 0; i < tables.size(); i++) {
+		splashReady.push_back(splashImported[i].get_future());
+		assetsReady.push_back(std::async(std::launch::async, [&, i]() {
+
+			// find asset source, import splash and hand it to the main thread
+			Graphics* graphics = tables[i]->getGraphics();
+			graphics->openAssets(ASSET_PATH);
+			bool complete = graphics->importAsset(GRAPHICS_ASSET_SPLASH);
+			splashImported[i].set_value(complete);
+
+			// import remaining assets, checking every one so all problems are reported at once
+			for (int a = 0; a < GRAPHICS_ASSET_COUNT; a++)
+				if (a != GRAPHICS_ASSET_SPLASH)
+					complete = graphics->importAsset(a) && complete;
+
+			// report whether every asset imported
+			complete = complete && graphics->finishImport();
+			logStartupPhase("assets " + std::to_string(i + 1) + " ready");
+			return complete;
+		}));
 	}
 
-	// create window
+	// create windows on the main thread (HighGUI requirement on some platforms)
+	for (size_t i = 0; i < tables.size(); i++) {
 #ifdef __APPLE__
 
-	// fullscreen crashes on Mac, don't use it
-	graphics->spawnWindow(false);
+		// fullscreen crashes on Mac, don't use it
+		tables[i]->getGraphics()->spawnWindow(false);
 #else
 
-	// fullscreen works on real computers, use it
-	graphics->spawnWindow(true);
+		// fullscreen works on real computers, use it (not for a latency test, it shouldn't take over the display)
+		tables[i]->getGraphics()->spawnWindow(!latencyTest);
 #endif
+	}
+	logStartupPhase("windows ready");
+
+	// draw startup images as soon as they're imported, refresh screens, hold play until they expire (latency test skips the splash)
+	for (size_t i = 0; i < tables.size(); i++) {
+		if (splashReady[i].get() && !latencyTest) {
+			tables[i]->getGraphics()->drawStartupSplashImage();
+			tables[i]->getGraphics()->pushToScreen();
+			tables[i]->getState()->gameState = SETUP;
+			logStartupPhase("splash " + std::to_string(i + 1) + " shown");
+		}
+	}
 
-	// draw startup image, refresh screen
-	graphics->drawStartupSplashImage();
-	graphics->pushToScreen();
-
-	// set puck to middle of table
-	physics->resetPuck(table_center);
-
-	// spawn physics and sensor threads, graphics to be handled on main thread
-	thread tPhysics(physicsThread);
-	thread tSensor(sensorThread);
-	
-	// set game state and call graphics on main thread
-	setGameState(IN_PLAY);
-	graphicsThread();
-
-	// wait for all threads to complete
-	tSensor.join();
-	tPhysics.join();
+	// wait for cameras, table calibration and physics
+	for (size_t i = 0; i < sensorsReady.size(); i++)
+		sensorsReady[i].get();
 
-	// terminate program with success
-	return EXIT_SUCCESS;
-}
+	// attempt to import assets, waiting for every table so all problems are reported
+	bool assetsComplete = true;
+	for (size_t i = 0; i < assetsReady.size(); i++)
+		assetsComplete = assetsReady[i].get() && assetsComplete;
+	if (!assetsComplete) {
 
-// Handles physics algorithm, acts as physics update loop
-void physicsThread() {
+		// report one or more missing asset(s)
+		std::cout << "ERROR: Asset(s) Missing, Check Directory" << std::endl;
 
-	// initialize lastTime for deltaTime calculations
-	auto lastTime = std::chrono::steady_clock::now();
+		// terminate program with failure
+		return EXIT_FAILURE;
+	}
 
-	// initialize lastTime and nFrames for FPS counter
-	auto lastTime_frameCounter = lastTime;
-	int frames = 0;
+	// check if calibration was requested (live cameras only), fit and save each table's camera before play
+	if (calibrateCameras && !latencyTest) {
+		for (size_t i = 0; i < tables.size(); i++) {
+			if (!tables[i]->calibrateCamera(CALIBRATION_FILE_PREFIX + std::to_string(cameras[i]) + ".bin"))
 
-	// iterate while the game is in play
-	while (game_in_play) {
+				// terminate program with failure
+				return EXIT_FAILURE;
+		}
+		logStartupPhase("cameras calibrated");
+	}
 
-		// record current time for deltaTime and FPS clock
-		auto currentTime = std::chrono::steady_clock::now();
+	// check if recording was requested, start writing the first table's frames
+	if (!recordPath.empty() && !tables[0]->getSensor()->startRecording(recordPath)) {
 
-		// compute deltaTime values (durations)
-		std::chrono::duration<long double, std::micro> deltaTime = currentTime - lastTime;
-		std::chrono::duration<double, std::micro> frameCountDur = currentTime - lastTime_frameCounter;
+		// report unwritable recording
+		std::cout << "ERROR: Can't Write Recording " << recordPath << std::endl;
 
-		// increment frame counter
-		frames++;
+		// terminate program with failure
+		return EXIT_FAILURE;
+	}
 
-		// check if frame counter should report
-		if (frameCountDur.count() >= 5e6) {
-			
-			// report FPS average over previous five seconds
-			std::cout << "Physics Framerate: " << frames / 5 << std::endl;
+	// render sprites for the calibrated tables, set pucks to the middle, start physics clocks
+	for (size_t i = 0; i < tables.size(); i++)
+		tables[i]->startPlay();
 
-			// reset frame counter
-			frames = 0;
+	// create the shared worker pool, one worker per core, for every table's sensor and physics work
+	workerPool = new WorkerPool(0);
 
-			// reset FPS trigger clock
-			lastTime_frameCounter = currentTime;
-		}
+	// spawn scheduler, one capture thread per camera (reads block) and metrics thread, graphics to be handled on main thread
+	thread tScheduler(schedulerThread);
+	std::vector<thread> tCaptures;
+	for (size_t i = 0; i < tables.size(); i++)
+		tCaptures.push_back(thread(captureThread, tables[i]));
+	thread tMetrics(metricsThread);
 
-		// check gameState
-		if(getGameState() == IN_PLAY)
+	// report startup done (play begins when the splashes' holds expire)
+	logStartupPhase("threads running (" + std::to_string(tables.size()) + " table(s), " + std::to_string(workerPool->getWorkerCount()) + " workers)");
 
-			// tick physics
-			physics->tick(deltaTime.count());
+	// check if testing latency, spawn thread to end and check the test
+	thread tLatencyTest;
+	if (latencyTest)
+		tLatencyTest = thread(latencyTestThread);
+	
+	// call graphics on main thread (play starts once the startup splashes' holds expire)
+	graphicsThread();
 
-		// check if a goal has been scored
-		if (physics->detectGoals() > 0)
+	// wait for all threads to complete
+	if (tLatencyTest.joinable())
+		tLatencyTest.join();
+	tMetrics.join();
+	for (size_t i = 0; i < tCaptures.size(); i++)
+		tCaptures[i].join();
+	tScheduler.join();
+
+	// stop workers once their current tasks finish, then release tables
+	delete workerPool;
+	for (size_t i = 0; i < tables.size(); i++)
+		delete tables[i];
+
+	// check if testing latency, terminate program with test result
+	if (latencyTest)
+		return latency_test_passed ? EXIT_SUCCESS : EXIT_FAILURE;
 
-			// check if player one scored a goal
-			if (physics->detectGoals() == 1)
+	// terminate program with success
+	return EXIT_SUCCESS;
+}
 
-				// increment score, check if player won game
-				if (++score_playerOne >= WINNING_SCORE) {
+// Logs how long after launch a startup phase finished (safe from any thread)
+void logStartupPhase(const std::string& phase) {
 
-					// change game state
-					setGameState(WIN_ONE);
+	// serialize lines from the startup workers
+	static std::mutex logLock;
+	std::lock_guard<std::mutex> lock(logLock);
 
-					// reset scores for new game
-					score_playerOne = 0;
-					score_playerTwo = 0;
+	// print elapsed time since launch
+	std::cout << "Startup: " << phase << " after " << std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - startup_time).count() << " ms" << std::endl;
+}
 
-					// reset puck to middle
-					physics->resetPuck(table_center);
-				}
-				else {
-					
-					// change game state
-					setGameState(GOAL_ONE);
+// Queues every table's physics batch once per graphics frame
+void schedulerThread() {
 
-					// reset puck to player two's side
-					physics->resetPuck(table_centerRight);
-				}
-			else
+	// physics runs in batches, one batch per graphics frame
+	const std::chrono::duration<long double, std::micro> batchDuration(1e6L / GRAPHICS_TARGET_FRAMERATE);
 
-				// increment score, check if player won game
-				if (++score_playerTwo >= WINNING_SCORE) {
+	// initialize wake-up deadline for the next batch
+	auto nextBatchTime = std::chrono::steady_clock::now();
 
-					// change game state
-					setGameState(WIN_TWO);
+	// iterate while the game is in play
+	while (game_in_play) {
 
-					// reset scores for new game
-					score_playerOne = 0;
-					score_playerTwo = 0;
+		// queue a batch for every table (a table whose last batch is still running catches up in that one)
+		for (size_t i = 0; i < tables.size(); i++)
+			tables[i]->schedulePhysics(*workerPool);
 
-					// reset puck to middle
-					physics->resetPuck(table_center);
-				}
-				else {
+		// schedule next batch one graphics frame after the last
+		nextBatchTime += std::chrono::duration_cast<std::chrono::steady_clock::duration>(batchDuration);
 
-					// change game state
-					setGameState(GOAL_TWO);
+		// resynchronize schedule if batch overran its deadline
+		auto currentTime = std::chrono::steady_clock::now();
+		if (nextBatchTime < currentTime)
+			nextBatchTime = currentTime + std::chrono::duration_cast<std::chrono::steady_clock::duration>(batchDuration);
 
-					// reset puck to player ones side
-					physics->resetPuck(table_centerLeft);
-				}
-		
-		// save time at which frame began
-		lastTime = currentTime;
+		// sleep until the next batch is due instead of spinning
+		std::this_thread::sleep_until(nextBatchTime);
 	}
 }
 
-
-// Handles graphics assembly, celebration screens and display
+// Handles graphics assembly, celebration screens and display for every table
 void graphicsThread() {
 
-	// initialize lastTime for deltaTime calculations
-	auto lastTime = std::chrono::steady_clock::now();
+	// time between frames at the target framerate
+	const std::chrono::steady_clock::duration framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / GRAPHICS_TARGET_FRAMERATE));
+
+	// initialize wake-up deadline for the next frame
+	auto nextFrameTime = std::chrono::steady_clock::now();
 
-	// initialize lastTime and counter for FPS calculation
-	auto lastTime_frameCounter = lastTime;
-	int frames = 0;
+	// first gameplay image on every table marks the end of startup
+	bool playableLogged = false;
 
 	// iterate while game is in play
 	while (game_in_play) {
 
-		// record start of frame time
-		auto currentTime = std::chrono::steady_clock::now();
-
-		// calculate deltaTimes (durations)
-		std::chrono::duration<double, std::micro> deltaTime = currentTime - lastTime;
-		std::chrono::duration<double, std::micro> frameCountDur = currentTime - lastTime_frameCounter;
-		
-		// increment frames
-		frames++;
-
-		// check if FPS needs reporting
-		if (frameCountDur.count() >= 5e6) {
-
-			// report FPS average over five seconds
-			std::cout << "Graphics Framerate: " << frames / 5 << std::endl;
-			
-			// reset frame counter
-			frames = 0;
-
-			// reset FPS trigger timing
-			lastTime_frameCounter = currentTime;
+		// draw and present every table's next screen
+		for (size_t i = 0; i < tables.size(); i++)
+			tables[i]->drawFrame();
+
+		// check if every table now shows gameplay, log time-to-playable
+		if (!playableLogged) {
+			bool playable = true;
+			for (size_t i = 0; i < tables.size(); i++)
+				playable = playable && tables[i]->isPlayable();
+			if (playable) {
+				logStartupPhase("playable");
+				playableLogged = true;
+			}
 		}
 
-		// check if gameState needs resetting, record evaluation
-		bool reset_state = (getGameState() != IN_PLAY);
+		// schedule next frame one period after the last
+		nextFrameTime += framePeriod;
 
-		// check if game is in play
-		if (getGameState() == IN_PLAY)
+		// resynchronize schedule if frame overran its deadline
+		auto currentTime = std::chrono::steady_clock::now();
+		if (nextFrameTime < currentTime)
+			nextFrameTime = currentTime + framePeriod;
 
-			// assemble game-in-play image
-			graphics->drawGameplayImage();
+		// sleep until the next frame is due instead of spinning
+		std::this_thread::sleep_until(nextFrameTime);
+	}
+}
 
-		// check if player one has scored
-		else if (getGameState() == GOAL_ONE)
+// Ends a latency test after its duration, then checks the motion-to-photon accounting it produced
+void latencyTestThread() {
 
-			// create player-one-scored screen
-			graphics->drawGoalscoredImage(true);
+	// let the pipeline run on synthetic frames
+	std::this_thread::sleep_for(std::chrono::milliseconds(LATENCY_TEST_DURATION));
 
-		// check if player two has scored
-		else if (getGameState() == GOAL_TWO)
+	// stop every thread
+	game_in_play = false;
 
-			// create player-two-scored screen
-			graphics->drawGoalscoredImage(false);
+	// snapshot the table's queue and end-to-end stages over the whole test
+	Metrics& metrics = tables[0]->getMetrics();
+	std::vector<uint64_t> queue(HISTOGRAM_BUCKETS), total(HISTOGRAM_BUCKETS);
+	metrics.stage(STAGE_M2P_QUEUE).snapshot(&queue[0]);
+	metrics.stage(STAGE_M2P_TOTAL).snapshot(&total[0]);
 
-		// check if player one has won
-		else if (getGameState() == WIN_ONE)
+	// frames accounted, out-of-order traces and fastest observed queue stage (can't be below the injected delay)
+	uint64_t frames = LatencyHistogram::total(&total[0]);
+	unsigned long violations = metrics.getTraceViolationCount();
+	double queueFloor_ms = LatencyHistogram::quantile(&queue[0], 0.0) / 1e6;
 
-			// create player-one-win screen
-			graphics->drawGamewonImage(true);
+	// report test summary
+	std::cout << "Latency Test Frames Traced: " << frames << std::endl;
+	std::cout << "Latency Test Out-Of-Order Traces: " << violations << std::endl;
+	std::cout << "Latency Test Fastest Queue Stage (ms): " << queueFloor_ms << " (injected " << LATENCY_TEST_DELAY_MS << ")" << std::endl;
+	std::cout << "Latency Test Motion-To-Photon p50/p99 (ms): " << LatencyHistogram::quantile(&total[0], 0.5) / 1e6 << "/" << LatencyHistogram::quantile(&total[0], 0.99) / 1e6 << std::endl;
 
-		// check if player two has won
-		else if (getGameState() == WIN_TWO)
+	// pass if frames made it through with consistent stamps and the injected delay was accounted (histogram buckets round down by at most 1/16)
+	latency_test_passed = frames > 0 && violations == 0 && queueFloor_ms >= LATENCY_TEST_DELAY_MS * (1.0 - 1.0 / HISTOGRAM_SUB_BUCKETS);
+	std::cout << "Latency Test: " << (latency_test_passed ? "PASS" : "FAIL") << std::endl;
+}
 
-			// create player-two-win screen
-			graphics->drawGamewonImage(false);
-		
-		// move assembled frame from buffer to screen
-		graphics->pushToScreen();
-		
-		// recall flag from before frame
-		if(reset_state)
+// Handles one table's camera capture, queues sensor work for each frame on the pool
+void captureThread(GameTable* table) {
 
-			// reset flag to indicate celebration screen was shown
-			setGameState(IN_PLAY);
+	// iterate while game is in play and the camera is delivering (an ended source ends this thread)
+	while (game_in_play && !table->getSensor()->hasSourceEnded())
 
-		// record time of frame start
-		lastTime = currentTime;
-	}
+		// block on camera, publish frame and queue its processing
+		table->captureFrame(*workerPool);
 }
 
-// Handles sensor frame gathering and position data extraction
-void sensorThread() {
+// Reports each table's latency and sensor counters off the hot path
+void metricsThread() {
 
-	// initialize lastTime for deltaTime calculations
-	auto lastTime = std::chrono::steady_clock::now();
-
-	// initialize lastTime and framecounter for FPS reporting
-	auto lastTime_frameCounter = lastTime;
-	int frames = 0;
+	// initialize report clock
+	auto lastReportTime = std::chrono::steady_clock::now();
+	auto nextReportTime = lastReportTime;
 
 	// iterate while game is in play
 	while (game_in_play) {
 
-		// record time of frame start
-		auto currentTime = std::chrono::steady_clock::now();
+		// sleep until the next report is due
+		nextReportTime += std::chrono::milliseconds(METRICS_REPORT_INTERVAL);
+		std::this_thread::sleep_until(nextReportTime);
 
-		// calculate deltaTimes (durations)
-		std::chrono::duration<double, std::micro> deltaTime = currentTime - lastTime;
-		std::chrono::duration<double, std::micro> frameCountDur = currentTime - lastTime_frameCounter;
-		
-		// increment frames
-		frames++;
-
-		// check if FPS needs to be reported
-		if (frameCountDur.count() >= 5e6) {
-
-			// report FPS average over previous five seconds
-			std::cout << "Sensor Framerate: " << frames / 5 << std::endl;
-			
-			// reset frame counter
-			frames = 0;
-
-			// reset FPS trigger timer
-			lastTime_frameCounter = currentTime;
-		}
-
-		// pull image from sensor buffer into memory
-		sensor->collectFrameFromCamera();
-
-		// perform image processing and extract data
-		sensor->processFrame();
-
-		// update positions of paddles for physics and graphics processing
-		sensor->updatePaddles(deltaTime.count());
+		// measure actual interval covered by this report
+		auto currentTime = std::chrono::steady_clock::now();
+		std::chrono::duration<double> interval = currentTime - lastReportTime;
+		lastReportTime = currentTime;
 
-		// preserve time of frame start
-		lastTime = currentTime;
+		// print and publish every table's report (pool wait stages show whether any table is starved of workers)
+		for (size_t i = 0; i < tables.size(); i++)
+			tables[i]->reportMetrics(interval.count());
+		std::cout << "Worker Pool Workers/Steals (total): " << workerPool->getWorkerCount() << "/" << workerPool->getStealCount() << std::endl;
 	}
-}
\ No newline at end of file
+}
@@ -1,49 +1,42 @@
 #pragma once
 #include "GameData.h"
-#include "Graphics.h"
-#include "Physics.h"
-#include "Sensor.h"
+#include "GameTable.h"
+#include "WorkerPool.h"
+#include <sstream>
+#include <future>
 
-// game state flags
-bool game_in_play = true;
-int gameState = IN_PLAY;
+// game running flag, cleared to stop every thread
+std::atomic<bool> game_in_play(true);
 
-// puck position and velocity
-double puck_position[2] = { 0,0 }, puck_velocity[2] = { 0,0 };
+// one game per projected table (camera)
+std::vector<GameTable*> tables;
 
-// paddle positions and velocities
-double paddleOne_position[2] = { 0,0 }, paddleOne_velocity[2] = { 0,0 };
-double paddleTwo_position[2] = { 0,0 }, paddleTwo_velocity[2] = { 0,0 };
+// shared pool running every table's sensor and physics work
+WorkerPool* workerPool;
 
-// table dimensions and important points
-double table_width = 0, table_height = 0, table_center[2] = { 0,0 }, table_centerLeft[2] = { 0,0 }, table_centerRight[2] = { 0,0 };
+// time the program started, for startup phase logging
+std::chrono::steady_clock::time_point startup_time;
 
-// game score
-int score_playerOne = 0, score_playerTwo = 0;
+// latency test result, set by the latency test thread
+bool latency_test_passed = false;
 
-// Main, handles setup and spawns physics, sensor and graphics threads
-int main();
+// Main, handles setup and spawns the worker pool, scheduler, capture, metrics and graphics threads
+int main(int, char**);
 
-// Handles physics algorithm, acts as physics update loop
-void physicsThread();
+// Logs how long after launch a startup phase finished (safe from any thread)
+void logStartupPhase(const std::string&);
 
-// Handles graphics assembly, celebration screens and display
-void graphicsThread();
+// Queues every table's physics batch once per graphics frame
+void schedulerThread();
 
-// Handles sensor frame gathering and position data extraction
-void sensorThread();
+// Handles graphics assembly, celebration screens and display for every table
+void graphicsThread();
 
-// thread cross-modification protection instance
-std::mutex mu;
+// Ends a latency test after its duration, then checks the motion-to-photon accounting it produced
+void latencyTestThread();
 
-// thread-safe gameState flag modifier
-void setGameState(int new_state) {
-	mu.lock();
-	gameState = new_state;
-	mu.unlock();
-}
+// Handles one table's camera capture, queues sensor work for each frame on the pool
+void captureThread(GameTable*);
 
-// thread-safe gameState flag retriever
-int getGameState() {
-	return gameState;
-}
\ No newline at end of file
+// Reports each table's latency and sensor counters off the hot path
+void metricsThread();
@@ -0,0 +1,420 @@
+#include "GameTable.h"
+
+// Constructor, numbered table (from 0) with its graphics, no sensor or physics until calibrated
+GameTable::GameTable(const int index) : sensorRequests(0), physicsQueued(false), physicsAccumulator(0) {
+
+	// remember table number
+	tableIndex = index;
+
+	// create graphics for this table's window
+	graphics = new Graphics(&state, index);
+
+	// no sensor, physics or opponent until calibrated
+	sensor = NULL;
+	physics = NULL;
+	opponent = NULL;
+
+	// nothing held or shown yet
+	holdingScreen = false;
+	playable = false;
+	lastTracedCapture = 0;
+	physicsLastTime = std::chrono::steady_clock::now();
+}
+
+// Destructor, releases sensor, physics, CPU opponent and graphics
+GameTable::~GameTable() {
+
+	// release instances (NULL is safe to delete)
+	delete physics;
+	delete opponent;
+	delete sensor;
+	delete graphics;
+}
+
+// Takes ownership of the table's sensor, calibrates the table size from it and creates physics with the given number of pucks, the CPU opponent plays paddle two if asked
+void GameTable::calibrate(Sensor* tableSensor, const int puckCount, const bool singlePlayer) {
+
+	// calibrate table size
+	sensor = tableSensor;
+	sensor->detectProjectionSize();
+
+	// create physics instance (more than one puck is the multi-puck party mode)
+	physics = new Physics(&state, puckCount);
+
+	// check for single-player mode, hand paddle two to the CPU opponent (the sensor's paddle two estimate goes unused)
+	if (singlePlayer) {
+		opponent = new PaddleAI(&state, false);
+		physics->setOpponent(opponent);
+	}
+}
+
+// Projects a grid of markers, pairs each with where the sensor sees it and fits the camera calibration, saving it to the given file, returns false if the fit fails
+bool GameTable::calibrateCamera(const std::string& path) {
+
+	// matched marker positions in sensor space and projected image space
+	std::vector<cv::Point2f> sensorPoints;
+	std::vector<Vec2> projectedPoints;
+
+	// iterate through marker grid, spread evenly inside the margin
+	for (int row = 0; row < CALIBRATION_GRID_ROWS; row++) {
+		for (int column = 0; column < CALIBRATION_GRID_COLUMNS; column++) {
+
+			// calculate marker position on the projected image
+			Vec2 marker(OUTPUT_IMAGE_WIDTH * (CALIBRATION_MARGIN + (1 - 2 * CALIBRATION_MARGIN) * column / (CALIBRATION_GRID_COLUMNS - 1)), OUTPUT_IMAGE_HEIGHT * (CALIBRATION_MARGIN + (1 - 2 * CALIBRATION_MARGIN) * row / (CALIBRATION_GRID_ROWS - 1)));
+
+			// project marker alone
+			graphics->drawCalibrationMarker(marker);
+			graphics->pushToScreen();
+
+			// keep camera and window serviced while the marker settles (frames from before it appeared are superseded)
+			while (graphics->isHolding()) {
+				sensor->collectFrameFromCamera();
+				graphics->refreshWindow();
+			}
+
+			// take a frame captured after the marker settled
+			if (!sensor->collectFrameFromCamera() || !sensor->nextFrame(0))
+				continue;
+
+			// check if marker was found, record the pair
+			cv::Point2f seen;
+			if (sensor->detectMarker(seen)) {
+				sensorPoints.push_back(seen);
+				projectedPoints.push_back(marker);
+			}
+			else
+				graphics->printStatusToConsole("Calibration Marker " + std::to_string(row * CALIBRATION_GRID_COLUMNS + column + 1) + " Not Seen");
+		}
+	}
+
+	// fit lens and homography to the markers seen
+	CameraCalibration fitted;
+	if (!fitted.solve(sensorPoints, projectedPoints, sensor->getFrameWidth(), sensor->getFrameHeight())) {
+
+		// report too few (or degenerate) markers
+		std::cout << "ERROR: Can't Calibrate Table " << tableIndex + 1 << ", " << sensorPoints.size() << " Marker(s) Seen" << std::endl;
+		return false;
+	}
+
+	// report fit quality
+	std::cout << "Table " << tableIndex + 1 << " Calibration Markers/RMS Error (px): " << sensorPoints.size() << "/" << fitted.getError() << std::endl;
+
+	// check fit is close enough to play on
+	if (fitted.getError() > CALIBRATION_MAX_ERROR) {
+
+		// report poor fit
+		std::cout << "ERROR: Calibration Error Too Large, Check Camera View" << std::endl;
+		return false;
+	}
+
+	// check if fit can be saved for later runs
+	if (!fitted.save(path)) {
+
+		// report unwritable calibration
+		std::cout << "ERROR: Can't Write Calibration " << path << std::endl;
+		return false;
+	}
+
+	// map this run's detections through the new fit
+	sensor->setCalibration(fitted);
+	return true;
+}
+
+// Returns the state the table's sensor, physics and graphics share
+TableState* GameTable::getState() {
+
+	// report shared state
+	return &state;
+}
+
+// Returns the table's sensor (NULL before calibration)
+Sensor* GameTable::getSensor() {
+
+	// report sensor
+	return sensor;
+}
+
+// Returns the table's graphics
+Graphics* GameTable::getGraphics() {
+
+	// report graphics
+	return graphics;
+}
+
+// Returns the table's latency metrics
+Metrics& GameTable::getMetrics() {
+
+	// report metrics
+	return metrics;
+}
+
+// Puts the puck in the middle and starts the physics clock, play begins once any held screen expires
+void GameTable::startPlay() {
+
+	// render sprites for the calibrated table
+	graphics->scaleToTable();
+
+	// set puck to middle of table
+	physics->resetPuck(state.table_center);
+
+	// a held screen (startup splash) is up whenever play is paused
+	holdingScreen = (state.gameState != IN_PLAY);
+
+	// physics owes no time yet
+	physicsLastTime = std::chrono::steady_clock::now();
+	physicsAccumulator = std::chrono::duration<long double, std::micro>(0);
+}
+
+// Captures one camera frame and queues sensor work for it on the pool, returns false if none was published (empty grab or ended source)
+bool GameTable::captureFrame(WorkerPool& pool) {
+
+	// block on camera and publish frame, timed
+	bool captured;
+	{
+		ScopedTimer timer(metrics.stage(STAGE_CAPTURE));
+		captured = sensor->collectFrameFromCamera();
+	}
+
+	// check if a frame was published, report a camera that stopped delivering
+	if (!captured) {
+		if (sensor->hasSourceEnded() && !sensor->isReplaying())
+			std::cout << "ERROR: Table " << tableIndex + 1 << " Camera Lost, Check Connection" << std::endl;
+		return false;
+	}
+
+	// queue sensor work, unless a sensor task is already queued or running (it picks this frame up before finishing)
+	if (sensorRequests++ == 0) {
+		auto queuedTime = std::chrono::steady_clock::now();
+		pool.submit([this, &pool, queuedTime] { processFrames(pool, queuedTime); });
+	}
+
+	// report frame captured
+	return true;
+}
+
+// Sensor task, processes the newest frame and queues another pass if frames arrived meanwhile
+void GameTable::processFrames(WorkerPool& pool, const std::chrono::steady_clock::time_point queuedTime) {
+
+	// record how long the task waited for a worker
+	metrics.stage(STAGE_SENSOR_WAIT).record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - queuedTime).count()));
+
+	// captures this pass covers (processing the newest frame handles all of them)
+	int handled = sensorRequests.load();
+
+	// take newest frame without waiting, older untaken frames are dropped by the queue
+	if (sensor->nextFrame(0)) {
+
+		// perform image processing and extract data, timed
+		{
+			ScopedTimer timer(metrics.stage(STAGE_DETECT));
+			sensor->processFrame();
+		}
+
+		// update positions of paddles for physics and graphics processing, timed
+		{
+			ScopedTimer timer(metrics.stage(STAGE_UPDATE_PADDLES));
+			sensor->updatePaddles();
+		}
+	}
+
+	// drop the handled captures, queue another pass behind other tables' work if frames arrived meanwhile
+	if (sensorRequests.fetch_sub(handled) != handled) {
+		auto requeuedTime = std::chrono::steady_clock::now();
+		pool.submit([this, &pool, requeuedTime] { processFrames(pool, requeuedTime); });
+	}
+}
+
+// Queues the next physics batch on the pool, unless the last one is still queued or running
+void GameTable::schedulePhysics(WorkerPool& pool) {
+
+	// check if a batch is already queued or running, it catches up on the time this one would have stepped
+	if (physicsQueued.exchange(true))
+		return;
+
+	// queue batch
+	auto queuedTime = std::chrono::steady_clock::now();
+	pool.submit([this, queuedTime] { stepPhysics(queuedTime); });
+}
+
+// Physics task, steps physics up to now in fixed steps
+void GameTable::stepPhysics(const std::chrono::steady_clock::time_point queuedTime) {
+
+	// fixed physics step, PHYSICS_FRAME_RATIO steps per graphics frame
+	const std::chrono::duration<long double, std::micro> stepDuration(1e6L / (GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO));
+
+	// longest backlog of simulation time that will be caught up after a stall
+	const std::chrono::duration<long double, std::micro> maxAccumulated = std::chrono::duration<long double, std::micro>(1e6L / GRAPHICS_TARGET_FRAMERATE) * PHYSICS_MAX_CATCHUP_FRAMES;
+
+	// record current time for deltaTime, and how long the batch waited for a worker
+	auto currentTime = std::chrono::steady_clock::now();
+	metrics.stage(STAGE_PHYSICS_WAIT).record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(currentTime - queuedTime).count()));
+
+	// add elapsed time to the accumulator
+	physicsAccumulator += currentTime - physicsLastTime;
+
+	// clamp catch-up so a long stall doesn't cause a burst of steps
+	if (physicsAccumulator > maxAccumulated)
+		physicsAccumulator = maxAccumulated;
+
+	// consume accumulated time in fixed-size steps
+	while (physicsAccumulator >= stepDuration) {
+
+		// remove step from accumulator
+		physicsAccumulator -= stepDuration;
+
+		// the simulated state lags real time by whatever is still owed after this step
+		auto stepTime = currentTime - std::chrono::duration_cast<std::chrono::steady_clock::duration>(physicsAccumulator);
+
+		// check gameState
+		if (state.gameState == IN_PLAY) {
+
+			// tick physics, timed
+			{
+				ScopedTimer timer(metrics.stage(STAGE_TICK));
+				physics->tick(stepDuration.count(), std::chrono::duration<double>(stepTime.time_since_epoch()).count());
+			}
+
+			// check if a goal has been scored (only in play, another puck already in a goal scores once the celebration ends)
+			physics->scoreGoals();
+		}
+	}
+
+	// save time at which batch began
+	physicsLastTime = currentTime;
+
+	// let the next batch be queued
+	physicsQueued = false;
+}
+
+// Draws and presents the table's next screen (gameplay or celebration), only services the window while a screen is held
+void GameTable::drawFrame() {
+
+	// check if a held screen is still within its hold time, keep window responsive without redrawing
+	if (graphics->isHolding())
+		graphics->refreshWindow();
+
+	// check if a held screen just expired, resume play (physics waits on this)
+	else if (holdingScreen) {
+		holdingScreen = false;
+		state.gameState = IN_PLAY;
+	}
+
+	// check if game is in play
+	else if (state.gameState == IN_PLAY) {
+
+		// assemble game-in-play image, timed
+		{
+			ScopedTimer timer(metrics.stage(STAGE_DRAW));
+			graphics->drawGameplayImage();
+		}
+
+		// move assembled frame from buffer to screen, timed and traced
+		auto drawnTime = std::chrono::steady_clock::now();
+		graphics->pushToScreen();
+		auto presentedTime = std::chrono::steady_clock::now();
+		metrics.stage(STAGE_IMSHOW).record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(presentedTime - drawnTime).count()));
+		traceMotionToPhoton(drawnTime, presentedTime);
+
+		// table is playable once a gameplay image is up
+		playable = true;
+	}
+	else {
+
+		// check if player one has scored
+		if (state.gameState == GOAL_ONE)
+
+			// create player-one-scored screen
+			graphics->drawGoalscoredImage(true);
+
+		// check if player two has scored
+		else if (state.gameState == GOAL_TWO)
+
+			// create player-two-scored screen
+			graphics->drawGoalscoredImage(false);
+
+		// check if player one has won
+		else if (state.gameState == WIN_ONE)
+
+			// create player-one-win screen
+			graphics->drawGamewonImage(true);
+
+		// check if player two has won
+		else if (state.gameState == WIN_TWO)
+
+			// create player-two-win screen
+			graphics->drawGamewonImage(false);
+
+		// show celebration screen and start its hold (untimed, holds are deliberate)
+		graphics->pushToScreen();
+		holdingScreen = true;
+	}
+}
+
+// Reports whether the table has shown a gameplay image yet
+bool GameTable::isPlayable() {
+
+	// report flag
+	return playable;
+}
+
+// Accounts a presented gameplay image's camera frame once, on the first present showing it
+void GameTable::traceMotionToPhoton(const std::chrono::steady_clock::time_point& drawnTime, const std::chrono::steady_clock::time_point& presentedTime) {
+
+	// trace of the camera frame behind the presented image
+	FrameTrace trace = graphics->getDrawnTrace();
+
+	// check if image shows a camera frame not yet accounted (repeats would only measure how long it stayed on screen)
+	if (trace.captured == 0 || trace.captured == lastTracedCapture)
+		return;
+	lastTracedCapture = trace.captured;
+
+	// record stage breakdown
+	metrics.traceFrame(trace, std::chrono::duration<double>(drawnTime.time_since_epoch()).count(), std::chrono::duration<double>(presentedTime.time_since_epoch()).count());
+}
+
+// Reports the table's latency stages and sensor counters since the last report
+void GameTable::reportMetrics(const double interval_secs) {
+
+	// gather table number and sensor running totals
+	std::ostringstream sensorFields;
+	sensorFields << "\"table\": " << tableIndex + 1 << ", \"sensor_processed\": " << sensor->getProcessedFrameCount() << ", \"sensor_dropped\": " << sensor->getDroppedFrameCount() << ", \"sensor_allocating_frames\": " << sensor->getFrameAllocationCount();
+
+	// print and publish report
+	std::cout << "Table " << tableIndex + 1 << " Latency:" << std::endl;
+	metrics.report(interval_secs, sensorFields.str());
+	std::cout << "Sensor Processed/Dropped/Allocating Frames (total): " << sensor->getProcessedFrameCount() << "/" << sensor->getDroppedFrameCount() << "/" << sensor->getFrameAllocationCount() << std::endl;
+}
+
+// Replays a recording headless and as fast as possible, physics steps on recorded time so runs are bit-identical
+bool GameTable::replayRecording() {
+
+	// record wall time to report replay speed
+	auto wallStart = std::chrono::steady_clock::now();
+
+	// replay every recorded frame through the sensor and physics
+	ReplayRunner replay(&state, sensor, physics);
+	bool replayed = replay.run();
+
+	// calculate replay duration
+	std::chrono::duration<double> wallTime = std::chrono::steady_clock::now() - wallStart;
+
+	// report replay summary, hash must match between runs of the same recording
+	std::cout << "Replay Frames: " << replay.getFrameCount() << std::endl;
+	std::cout << "Replay Physics Steps: " << replay.getStepCount() << std::endl;
+	std::cout << "Replay Score: " << state.score_playerOne << " - " << state.score_playerTwo << std::endl;
+	std::cout << "Replay Trajectory Hash: " << std::hex << replay.getTrajectoryHash() << std::dec << std::endl;
+	std::cout << "Replay Wall Time (s): " << wallTime.count() << std::endl;
+
+	// check if recording held any frames
+	if (!replayed) {
+
+		// report unreadable recording
+		std::cout << "ERROR: Recording Missing or Empty" << std::endl;
+
+		// report failure
+		return false;
+	}
+
+	// report success
+	return true;
+}
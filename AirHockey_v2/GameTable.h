@@ -0,0 +1,107 @@
+#pragma once
+#include "GameData.h"
+#include "Graphics.h"
+#include "PaddleAI.h"
+#include "Physics.h"
+#include "Sensor.h"
+#include "Metrics.h"
+#include "ReplayRunner.h"
+#include "ScopedTimer.h"
+#include "WorkerPool.h"
+#include <sstream>
+
+// One projected table's game, owns its shared state, sensor, physics, graphics and latency metrics
+// Sensor and physics work runs as tasks on a worker pool shared by every table, graphics on the main thread
+class GameTable {
+public:
+
+	// Constructor, numbered table (from 0) with its graphics, no sensor or physics until calibrated
+	GameTable(const int);
+
+	// Destructor, releases sensor, physics, CPU opponent and graphics
+	~GameTable();
+
+	// Takes ownership of the table's sensor, calibrates the table size from it and creates physics with the given number of pucks, the CPU opponent plays paddle two if asked
+	void calibrate(Sensor*, const int, const bool);
+
+	// Projects a grid of markers, pairs each with where the sensor sees it and fits the camera calibration, saving it to the given file, returns false if the fit fails
+	bool calibrateCamera(const std::string&);
+
+	// Returns the state the table's sensor, physics and graphics share
+	TableState* getState();
+
+	// Returns the table's sensor (NULL before calibration)
+	Sensor* getSensor();
+
+	// Returns the table's graphics
+	Graphics* getGraphics();
+
+	// Returns the table's latency metrics
+	Metrics& getMetrics();
+
+	// Puts the puck in the middle and starts the physics clock, play begins once any held screen expires
+	void startPlay();
+
+	// Captures one camera frame and queues sensor work for it on the pool, returns false if none was published (empty grab or ended source)
+	bool captureFrame(WorkerPool&);
+
+	// Queues the next physics batch on the pool, unless the last one is still queued or running
+	void schedulePhysics(WorkerPool&);
+
+	// Draws and presents the table's next screen (gameplay or celebration), only services the window while a screen is held
+	void drawFrame();
+
+	// Reports whether the table has shown a gameplay image yet
+	bool isPlayable();
+
+	// Reports the table's latency stages and sensor counters since the last report
+	void reportMetrics(const double);
+
+	// Replays a recording headless and as fast as possible, physics steps on recorded time so runs are bit-identical
+	bool replayRecording();
+
+private:
+
+	// Sensor task, processes the newest frame and queues another pass if frames arrived meanwhile
+	void processFrames(WorkerPool&, const std::chrono::steady_clock::time_point);
+
+	// Physics task, steps physics up to now in fixed steps
+	void stepPhysics(const std::chrono::steady_clock::time_point);
+
+	// Accounts a presented gameplay image's camera frame once, on the first present showing it
+	void traceMotionToPhoton(const std::chrono::steady_clock::time_point&, const std::chrono::steady_clock::time_point&);
+
+	// table number (from 0)
+	int tableIndex;
+
+	// state shared by sensor, physics and graphics
+	TableState state;
+
+	// sensor, physics and graphics instances
+	Sensor* sensor;
+	Physics* physics;
+	Graphics* graphics;
+
+	// CPU opponent playing paddle two in single-player mode (NULL otherwise)
+	PaddleAI* opponent;
+
+	// per-stage latency histograms
+	Metrics metrics;
+
+	// captured frames not yet handled, a sensor task is queued or running while nonzero
+	std::atomic<int> sensorRequests;
+
+	// flag for a physics batch queued or running
+	std::atomic<bool> physicsQueued;
+
+	// time the last physics batch ran to and simulation time still owed (physics task only)
+	std::chrono::steady_clock::time_point physicsLastTime;
+	std::chrono::duration<long double, std::micro> physicsAccumulator;
+
+	// held screen (startup splash or celebration) up, first gameplay image shown (main thread only)
+	bool holdingScreen;
+	bool playable;
+
+	// capture time of the last camera frame accounted (main thread only)
+	double lastTracedCapture;
+};
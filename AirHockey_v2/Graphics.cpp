@@ -2,15 +2,44 @@
 
 using namespace cv;
 
-// Constructor, calculates conversion ratios, defaults hold time
-Graphics::Graphics() {
+// asset names (bundle entries and PNG file stems), indexed like assets
+static const char* assetNames[GRAPHICS_ASSET_COUNT] = { "startupSplash", "tableTop", "goalPlayerOne", "goalPlayerTwo", "winPlayerOne", "winPlayerTwo", "error" };
 
-	// calculate conversion ratios for table-to-graphics
-	widthRatio_tableToGraphics = OUTPUT_IMAGE_WIDTH / table_width;
-	heightRatio_tableToGraphics = OUTPUT_IMAGE_HEIGHT / table_height;
+// Constructor, draws the given table in its own window (numbered from 0), defaults hold time, nothing imported or scaled yet
+Graphics::Graphics(TableState* table, const int index) {
+
+	// remember table and name its window, further tables are numbered from 2
+	tableState = table;
+	tableIndex = index;
+	windowTitle = (index == 0) ? WINDOW_TITLE : WINDOW_TITLE " " + std::to_string(index + 1);
 
-	// default hold time
+	// not scaled to a table yet (scaleToTable, or the first gameplay image, does it)
+	widthRatio_tableToGraphics = 0;
+	heightRatio_tableToGraphics = 0;
+	spriteTable_width = 0;
+	spriteTable_height = 0;
+
+	// default hold time, nothing held yet
 	currentFrame_holdTime = 1;
+	holdEndTime = std::chrono::steady_clock::now();
+
+	// list assets in name order
+	assets[0] = &image_startupSplash;
+	assets[1] = &image_tableTop;
+	assets[2] = &image_goalPlayerOne;
+	assets[3] = &image_goalPlayerTwo;
+	assets[4] = &image_winPlayerOne;
+	assets[5] = &image_winPlayerTwo;
+	assets[6] = &image_error;
+
+	// nothing imported or drawn yet
+	assetsBundled = false;
+	presentedImage = &image_error;
+	staticLayerValid = false;
+	drawnTrace = FrameTrace();
+	dirtyRectCount = 0;
+	shownScore_playerOne = 0;
+	shownScore_playerTwo = 0;
 }
 
 // Prints a specified status message to the console
@@ -20,113 +49,317 @@ void Graphics::printStatusToConsole(std::string message) {
 	std::cout << "STATUS: " << message << std::endl;
 }
 
-// Creates the game window, fullscreen or not
+// Creates the game window, fullscreen or not, placed one projection width right of the previous table's
 void Graphics::spawnWindow(bool makeFullscreen) {
 
 	// spawn named window
-	namedWindow(WINDOW_TITLE, CV_WINDOW_NORMAL);
+	namedWindow(windowTitle, CV_WINDOW_NORMAL);
+
+	// place further tables' windows on the projectors extending the desktop to the right
+	if (tableIndex > 0)
+		moveWindow(windowTitle, tableIndex * static_cast<int>(OUTPUT_IMAGE_WIDTH), 0);
 
 	// check if fullscreen activated
 	if(makeFullscreen)
 
 		// make window fullscreen
-		setWindowProperty(WINDOW_TITLE, CV_WND_PROP_FULLSCREEN, CV_WINDOW_FULLSCREEN);
+		setWindowProperty(windowTitle, CV_WND_PROP_FULLSCREEN, CV_WINDOW_FULLSCREEN);
 }
 
-// Attempts to import gameplay assets
+// Attempts to import gameplay assets, from the packed bundle if there is one, reporting each asset that can't be used
 bool Graphics::importResources(std::string path = "C:") {
 
-// check OS, use proper syntax to attempt image imports
+	// find asset source
+	openAssets(path);
+
+	// iterate through assets, checking every one so all problems are reported at once
+	bool complete = true;
+	for (int i = 0; i < GRAPHICS_ASSET_COUNT; i++)
+		complete = importAsset(i) && complete;
+
+	// finish only if every asset imported
+	return complete && finishImport();
+}
+
+// Picks the asset source, the packed bundle if there is one (mapped), otherwise loose PNGs
+void Graphics::openAssets(std::string path) {
+
+// check OS, use proper path separator
 #ifdef _WIN32
-	image_startupSplash = imread(path + "\\startupSplash.png");
-	image_tableTop = imread(path + "\\tableTop.png");
-	image_goalPlayerOne = imread(path + "\\goalPlayerOne.png");
-	image_goalPlayerTwo = imread(path + "\\goalPlayerTwo.png");
-	image_winPlayerOne = imread(path + "\\winPlayerOne.png");
-	image_winPlayerTwo = imread(path + "\\winPlayerTwo.png");
-	image_error = imread(path + "\\error.png");
+	assetSeparator = "\\";
 #else
-	image_startupSplash = imread(path + "//startupSplash.png");
-	image_tableTop = imread(path + "//tableTop.png");
-	image_goalPlayerOne = imread(path + "//goalPlayerOne.png");
-	image_goalPlayerTwo = imread(path + "//goalPlayerTwo.png");
-	image_winPlayerOne = imread(path + "//winPlayerOne.png");
-	image_winPlayerTwo = imread(path + "//winPlayerTwo.png");
-	image_error = imread(path + "//error.png");
+	assetSeparator = "//";
 #endif
 
-	// check if any imports failed
-	if (image_startupSplash.empty() || image_tableTop.empty() || image_goalPlayerOne.empty() || image_goalPlayerTwo.empty() || image_winPlayerOne.empty() || image_winPlayerTwo.empty() || image_error.empty())
-		
-		// report failure
+	// remember directory for loose PNGs
+	assetPath = path;
+
+	// map pre-decoded bundle if there is one, otherwise decode loose PNGs
+	assetsBundled = assetBundle.open(assetPath + assetSeparator + ASSET_BUNDLE_NAME);
+	if (!assetsBundled)
+		printStatusToConsole("No Asset Bundle (" + assetBundle.getError() + "), Decoding PNGs");
+}
+
+// Imports one asset (GRAPHICS_ASSET_*) from the opened source, reports and returns false if it can't be used
+bool Graphics::importAsset(const int asset) {
+
+	// check if bundled, wrap mapped pixels (no decode, no copy)
+	if (assetsBundled) {
+		if (!assetBundle.find(assetNames[asset], *assets[asset])) {
+			std::cout << "ERROR: " << assetBundle.getError() << std::endl;
+			return false;
+		}
+	}
+	else {
+
+		// decode PNG
+		std::string file = assetPath + assetSeparator + assetNames[asset] + ".png";
+		*assets[asset] = imread(file, IMREAD_COLOR);
+		if (assets[asset]->empty()) {
+			std::cout << "ERROR: Can't Read Asset " << file << std::endl;
+			return false;
+		}
+
+		// scale loose PNGs to the projection (bundles are scaled when packed)
+		if (assets[asset]->cols != OUTPUT_IMAGE_WIDTH || assets[asset]->rows != OUTPUT_IMAGE_HEIGHT)
+			resize(*assets[asset], *assets[asset], Size(static_cast<int>(OUTPUT_IMAGE_WIDTH), static_cast<int>(OUTPUT_IMAGE_HEIGHT)), 0, 0, INTER_AREA);
+	}
+
+	// check asset is a projection-sized BGR image (a stale bundle may not be)
+	if (assets[asset]->cols != OUTPUT_IMAGE_WIDTH || assets[asset]->rows != OUTPUT_IMAGE_HEIGHT || assets[asset]->type() != CV_8UC3) {
+		std::cout << "ERROR: Asset " << assetNames[asset] << " Is " << assets[asset]->cols << "x" << assets[asset]->rows << " With " << assets[asset]->channels() << " Channel(s), Expected " << OUTPUT_IMAGE_WIDTH << "x" << OUTPUT_IMAGE_HEIGHT << " BGR (Repack Assets)" << std::endl;
 		return false;
+	}
+
+#ifndef NDEBUG
+
+	// fingerprint asset so debug builds catch any write to it
+	assetHashes[asset] = hashImage(*assets[asset]);
+#endif
 
 	// report success
 	return true;
 }
 
-// Prints contents of memory buffer to screen
-void Graphics::pushToScreen() {
+// Preallocates the owned gameplay buffers once every asset is imported, returns false if the table backdrop is missing
+bool Graphics::finishImport() {
 
-	// check if hold time is remarkable (not 1)
-	if (currentFrame_holdTime > 1) {
+	// check backdrop the buffers are sized from
+	if (image_tableTop.empty())
+		return false;
 
-		// record frame start time
-		auto frameTime = std::chrono::steady_clock::now();
+	// preallocate owned gameplay buffers like the table backdrop (they never reallocate after this), rebuild on first frame
+	staticLayer.create(image_tableTop.rows, image_tableTop.cols, image_tableTop.type());
+	gameplayBuffer.create(image_tableTop.rows, image_tableTop.cols, image_tableTop.type());
+	staticLayerValid = false;
 
-		// iterate while time has not expired
-		while (std::chrono::duration<long double, std::milli>(std::chrono::steady_clock::now() - frameTime).count() < currentFrame_holdTime) {
-			
-			// render buffer to screen, nudge CV to refresh
-			imshow(WINDOW_TITLE, screenBuffer);
-			waitKey(1);
-		}
-	}
-	else {
+	// report success
+	return true;
+}
 
-		// render buffer to screen, nudge CV to refresh
-		imshow(WINDOW_TITLE, screenBuffer);
-		waitKey(1);
-	}
+// Prints contents of memory buffer to screen and starts its hold time, doesn't wait for the hold
+void Graphics::pushToScreen() {
+
+	// check (debug builds) that no asset has been written, or that the gameplay buffer doesn't share an asset's pixels
+	assertAssetsIntact();
+
+	// render presented image to screen (framebuffer or asset, shown in place), nudge CV to refresh
+	imshow(windowTitle, *presentedImage);
+	waitKey(1);
+
+	// screen stays up until its hold time has passed (the render loop checks isHolding)
+	holdEndTime = std::chrono::steady_clock::now() + std::chrono::milliseconds(currentFrame_holdTime);
 
 	// reset hold time
 	currentFrame_holdTime = 1;
 
-	// reset buffer to error screen
-	screenBuffer = image_error;
+	// reset presented image to error screen
+	presentedImage = &image_error;
+}
+
+// Reports whether the last presented screen is still within its hold time
+bool Graphics::isHolding() {
+
+	// compare against hold deadline
+	return std::chrono::steady_clock::now() < holdEndTime;
+}
+
+// Services window events while a held screen stays up
+void Graphics::refreshWindow() {
+
+	// nudge CV to process window events, image is unchanged
+	waitKey(1);
 }
 
-// Assembles the in-play game image
+// Assembles the in-play game image, rewriting only the regions that changed since the last one
 void Graphics::drawGameplayImage() {
 
-	// copy table backdrop to buffer
-	image_tableTop.copyTo(screenBuffer);
+	// read a consistent snapshot of the puck and paddles
+	WorldState world = tableState->world_state.load();
 
-	// draw goal boxes to buffer
-	rectangle(screenBuffer, Rect(Point2d((widthRatio_tableToGraphics*table_width) - (widthRatio_tableToGraphics * WALL_PADDING_THICKNESS), heightRatio_tableToGraphics * (table_height - GOAL_WIDTH) / 2.0), Point2d((widthRatio_tableToGraphics*table_width), heightRatio_tableToGraphics * (table_height + GOAL_WIDTH) / 2.0)), Scalar(0, 0, 0), -1);
-	rectangle(screenBuffer, Rect(Point2d(0, heightRatio_tableToGraphics * (table_height - GOAL_WIDTH) / 2.0), Point2d((widthRatio_tableToGraphics * WALL_PADDING_THICKNESS), heightRatio_tableToGraphics * (table_height + GOAL_WIDTH) / 2.0)), Scalar(0, 0, 0), -1);
+	// remember which camera frame this image shows
+	drawnTrace = world.trace;
 
+	// check if table size changed, rescale sprites and force a full redraw
+	if (tableState->table_width != spriteTable_width || tableState->table_height != spriteTable_height)
+		scaleToTable();
 
-	// draw scores to buffer
-	putText(screenBuffer, std::to_string(static_cast<int>(score_playerOne)), Point2d((widthRatio_tableToGraphics * table_width * 0.5) - 80, (heightRatio_tableToGraphics * table_height) - 60), FONT_HERSHEY_SIMPLEX, 1.5, Scalar(50, 95, 105), 5);
-	putText(screenBuffer, std::to_string(static_cast<int>(score_playerTwo)), Point2d((widthRatio_tableToGraphics * table_width * 0.5) + 40, (heightRatio_tableToGraphics * table_height) - 60), FONT_HERSHEY_SIMPLEX, 1.5, Scalar(50, 95, 105), 5);
+	// check if gameplay buffer holds no earlier frame (first frame or table rescaled)
+	if (!staticLayerValid) {
 
-	// draw puck to buffer
-	circle(screenBuffer, Point2d((puck_position[0] * widthRatio_tableToGraphics), (puck_position[1] * heightRatio_tableToGraphics)), PUCK_RADIUS * widthRatio_tableToGraphics, Scalar(10, 80, 10), -1);
-	
-	// draw paddle rings to buffer
-	circle(screenBuffer, Point2d((paddleOne_position[0] * widthRatio_tableToGraphics), (paddleOne_position[1] * heightRatio_tableToGraphics)), PADDLE_RADIUS * widthRatio_tableToGraphics, Scalar(255, 0, 0), 5);
-	circle(screenBuffer, Point2d((paddleTwo_position[0] * widthRatio_tableToGraphics), (paddleTwo_position[1] * heightRatio_tableToGraphics)), PADDLE_RADIUS * widthRatio_tableToGraphics, Scalar(0, 0, 255), 5);
+		// composite static layer and start from a full copy of it (into the preallocated buffers)
+		buildStaticLayer();
+		staticLayer.copyTo(gameplayBuffer);
+		staticLayerValid = true;
+		dirtyRectCount = 0;
+	}
+
+	// check if either score changed, redraw score text on the static layer and mark it for restoring
+	else if (tableState->score_playerOne != shownScore_playerOne || tableState->score_playerTwo != shownScore_playerTwo) {
+
+		// region covering old and new score text
+		Rect scoreRegion = scoreRect(shownScore_playerOne, true) | scoreRect(shownScore_playerTwo, false) | scoreRect(tableState->score_playerOne, true) | scoreRect(tableState->score_playerTwo, false);
+
+		// restore backdrop under the scores, draw new scores
+		image_tableTop(scoreRegion).copyTo(staticLayer(scoreRegion));
+		drawScores();
+
+		// score region is restored with the moving elements
+		dirtyRects[dirtyRectCount++] = scoreRegion;
+	}
+
+	// restore static layer where the moving elements (and any score change) were
+	for (int i = 0; i < dirtyRectCount; i++)
+		staticLayer(dirtyRects[i]).copyTo(gameplayBuffer(dirtyRects[i]));
+
+	// start a new list of regions covered by moving elements
+	dirtyRectCount = 0;
+
+	// blend puck sprites into buffer, remember regions they cover (restored next frame)
+	for (int i = 0; i < world.puck_count; i++) {
+		Point puck(cvRound(world.puck_positions[i].x * widthRatio_tableToGraphics), cvRound(world.puck_positions[i].y * heightRatio_tableToGraphics));
+		dirtyRects[dirtyRectCount++] = puckSprite.blit(gameplayBuffer, puck);
+	}
+
+	// paddle centers in screen space
+	Point paddleOne(cvRound(world.paddleOne_position.x * widthRatio_tableToGraphics), cvRound(world.paddleOne_position.y * heightRatio_tableToGraphics));
+	Point paddleTwo(cvRound(world.paddleTwo_position.x * widthRatio_tableToGraphics), cvRound(world.paddleTwo_position.y * heightRatio_tableToGraphics));
+
+	// blend paddle ring sprites over the pucks, remember their regions too
+	dirtyRects[dirtyRectCount++] = paddleOneSprite.blit(gameplayBuffer, paddleOne);
+	dirtyRects[dirtyRectCount++] = paddleTwoSprite.blit(gameplayBuffer, paddleTwo);
+
+	// present owned gameplay buffer
+	presentedImage = &gameplayBuffer;
 	
 	// set hold time (minimum)
 	currentFrame_holdTime = 1;
 }
 
+// Composites the table backdrop, goal boxes and scores into the static layer
+void Graphics::buildStaticLayer() {
+
+	// copy table backdrop to static layer
+	image_tableTop.copyTo(staticLayer);
+
+	// draw goal boxes to static layer
+	rectangle(staticLayer, Rect(Point2d((widthRatio_tableToGraphics*tableState->table_width) - (widthRatio_tableToGraphics * WALL_PADDING_THICKNESS), heightRatio_tableToGraphics * (tableState->table_height - GOAL_WIDTH) / 2.0), Point2d((widthRatio_tableToGraphics*tableState->table_width), heightRatio_tableToGraphics * (tableState->table_height + GOAL_WIDTH) / 2.0)), Scalar(0, 0, 0), -1);
+	rectangle(staticLayer, Rect(Point2d(0, heightRatio_tableToGraphics * (tableState->table_height - GOAL_WIDTH) / 2.0), Point2d((widthRatio_tableToGraphics * WALL_PADDING_THICKNESS), heightRatio_tableToGraphics * (tableState->table_height + GOAL_WIDTH) / 2.0)), Scalar(0, 0, 0), -1);
+
+	// draw scores to static layer
+	drawScores();
+}
+
+// Draws the current scores onto the static layer, remembering them
+void Graphics::drawScores() {
+
+	// read scores once so text and remembered values agree
+	shownScore_playerOne = tableState->score_playerOne;
+	shownScore_playerTwo = tableState->score_playerTwo;
+
+	// blend score digits into static layer
+	drawNumber(shownScore_playerOne, scoreOrigin(true), true);
+	drawNumber(shownScore_playerTwo, scoreOrigin(false), true);
+}
+
+// Lays out a number's digit sprites from a text origin, blending them into the static layer if drawing, returns the region covered
+Rect Graphics::drawNumber(const int number, const Point& origin, const bool drawing) {
+
+	// region covered so far
+	Rect covered;
+
+	// iterate through digits left to right
+	Point position = origin;
+	std::string digits = std::to_string(number);
+	for (size_t i = 0; i < digits.size(); i++) {
+
+		// digit's sprite (non-digits such as a minus sign are skipped)
+		if (digits[i] < '0' || digits[i] > '9')
+			continue;
+		Sprite& glyph = digitSprites[digits[i] - '0'];
+
+		// blend or just measure digit
+		Rect region = drawing ? glyph.blit(staticLayer, position) : glyph.bounds(staticLayer, position);
+		covered = covered.area() ? (covered | region) : region;
+
+		// advance to next digit
+		position.x += glyph.getAdvance();
+	}
+
+	// report region covered
+	return covered;
+}
+
+// Finds the text origin of a player's score
+Point Graphics::scoreOrigin(const bool isPlayerOne) {
+
+	// scores sit either side of the table's bottom center
+	return Point2d((widthRatio_tableToGraphics * tableState->table_width * 0.5) + (isPlayerOne ? -80 : 40), (heightRatio_tableToGraphics * tableState->table_height) - 60);
+}
+
+// Finds the screen region a player's score text covers, clipped to the screen
+Rect Graphics::scoreRect(const int score, const bool isPlayerOne) {
+
+	// lay out digits without drawing them (sprite bounds are already clipped)
+	return drawNumber(score, scoreOrigin(isPlayerOne), false);
+}
+
+// Rescales conversion ratios and renders the puck, paddle ring and score digit sprites for the current table size, forcing a full redraw
+void Graphics::scaleToTable() {
+
+	// calculate conversion ratios for table-to-graphics
+	widthRatio_tableToGraphics = OUTPUT_IMAGE_WIDTH / tableState->table_width;
+	heightRatio_tableToGraphics = OUTPUT_IMAGE_HEIGHT / tableState->table_height;
+
+	// render puck and paddle rings
+	puckSprite.renderCircle(PUCK_RADIUS * widthRatio_tableToGraphics, Scalar(10, 80, 10), -1);
+	paddleOneSprite.renderCircle(PADDLE_RADIUS * widthRatio_tableToGraphics, Scalar(255, 0, 0), 5);
+	paddleTwoSprite.renderCircle(PADDLE_RADIUS * widthRatio_tableToGraphics, Scalar(0, 0, 255), 5);
+
+	// render score digits
+	for (int digit = 0; digit < 10; digit++)
+		digitSprites[digit].renderText(std::to_string(digit), FONT_HERSHEY_SIMPLEX, 1.5, Scalar(50, 95, 105), 5);
+
+	// remember table size the sprites were rendered for
+	spriteTable_width = tableState->table_width;
+	spriteTable_height = tableState->table_height;
+
+	// static layer was drawn at the old scale
+	staticLayerValid = false;
+}
+
+// Reports the camera frame trace behind the last gameplay image
+FrameTrace Graphics::getDrawnTrace() {
+
+	// report trace
+	return drawnTrace;
+}
+
 // Creates the game startup image
 void Graphics::drawStartupSplashImage() {
 
-	// draw startup image to buffer
-	screenBuffer = image_startupSplash;
+	// present startup image in place
+	presentedImage = &image_startupSplash;
 
 	// set hold time (remarkable)
 	currentFrame_holdTime = 3000;
@@ -138,12 +371,12 @@ void Graphics::drawGoalscoredImage(const bool wasPlayerOne) {
 	// check which player
 	if (wasPlayerOne)
 
-		// player-one-score screen to buffer
-		screenBuffer = image_goalPlayerOne;
+		// present player-one-score screen in place
+		presentedImage = &image_goalPlayerOne;
 	else
 
-		// player-two-screen to buffer
-		screenBuffer = image_goalPlayerTwo;
+		// present player-two-score screen in place
+		presentedImage = &image_goalPlayerTwo;
 
 	// set hold time (remarkable)
 	currentFrame_holdTime = 3000;
@@ -155,13 +388,65 @@ void Graphics::drawGamewonImage(const bool wasPlayerOne) {
 	// check which player
 	if (wasPlayerOne)
 
-		// player-one-win screen to buffer
-		screenBuffer = image_winPlayerOne;
+		// present player-one-win screen in place
+		presentedImage = &image_winPlayerOne;
 	else
 
-		// player-two-win screen to buffer
-		screenBuffer = image_winPlayerTwo;
+		// present player-two-win screen in place
+		presentedImage = &image_winPlayerTwo;
 
 	// set hold time (remarkable)
 	currentFrame_holdTime = 5000;
-}
\ No newline at end of file
+}
+
+// Creates a calibration screen, one marker at the given projected image point on black
+void Graphics::drawCalibrationMarker(const Vec2& marker) {
+
+	// clear calibration buffer to black (allocated once at the projected image size)
+	calibrationBuffer.create(static_cast<int>(OUTPUT_IMAGE_HEIGHT), static_cast<int>(OUTPUT_IMAGE_WIDTH), CV_8UC3);
+	calibrationBuffer.setTo(Scalar(0, 0, 0));
+
+	// draw solid white marker for the sensor to find
+	circle(calibrationBuffer, Point(static_cast<int>(marker.x), static_cast<int>(marker.y)), CALIBRATION_MARKER_RADIUS, Scalar(255, 255, 255), FILLED, LINE_AA);
+
+	// present calibration buffer
+	presentedImage = &calibrationBuffer;
+
+	// set hold time (marker settles before it's detected)
+	currentFrame_holdTime = CALIBRATION_SETTLE_MS;
+}
+
+// Checks (debug builds only) that the owned buffers never share an asset's pixels and that a presented asset is unchanged since import
+void Graphics::assertAssetsIntact() {
+#ifndef NDEBUG
+
+	// iterate through assets
+	for (int i = 0; i < GRAPHICS_ASSET_COUNT; i++) {
+
+		// check if gameplay buffer is about to be shown (every asset is imported by then), owned buffers must never alias an asset
+		if (presentedImage == &gameplayBuffer)
+			assert(assets[i]->data == NULL || (assets[i]->data != gameplayBuffer.data && assets[i]->data != staticLayer.data));
+
+		// check if this asset is about to be shown, its pixels must match the import (others may still be importing)
+		else if (presentedImage == assets[i])
+			assert(hashImage(*assets[i]) == assetHashes[i]);
+	}
+#endif
+}
+
+// Hashes an image's pixels row by row (FNV-1a)
+uint64_t Graphics::hashImage(const Mat& image) {
+
+	// FNV offset basis
+	uint64_t hash = 14695981039346656037ULL;
+
+	// iterate through rows, images may be views with padded rows
+	for (int y = 0; y < image.rows; y++) {
+		const uchar* pixel = image.ptr<uchar>(y);
+		for (size_t i = 0; i < image.cols * image.elemSize(); i++)
+			hash = (hash ^ pixel[i]) * 1099511628211ULL;
+	}
+
+	// report hash
+	return hash;
+}
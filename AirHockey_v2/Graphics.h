@@ -1,27 +1,61 @@
 #pragma once
 #include "GameData.h"
+#include "Sprite.h"
+#include "AssetBundle.h"
+
+// check OS, include OpenCV windowing and image file headers with proper file path format
+#ifdef _WIN32
+	#include <opencv2\highgui.hpp>
+	#include <opencv2\imgcodecs.hpp>
+#else
+	#include <opencv2/highgui.hpp>
+	#include <opencv2/imgcodecs.hpp>
+#endif
+#include <cassert>
+
 // Graphics handling class, assembles gameplay image and celebration screens, etc.
 class Graphics {
 public:
 
-	// Constructor, calculates conversion ratios, defaults hold time
-	Graphics();
+	// Constructor, draws the given table in its own window (numbered from 0), defaults hold time, nothing imported or scaled yet
+	Graphics(TableState*, const int);
 
 	// Prints a specified status message to the console
 	void printStatusToConsole(std::string message);
 
-	// Creates the game window, fullscreen or not
+	// Creates the game window, fullscreen or not, placed one projection width right of the previous table's
 	void spawnWindow(bool);
 
-	// Attempts to import gameplay assets
+	// Attempts to import gameplay assets, from the packed bundle if there is one, reporting each asset that can't be used
 	bool importResources(std::string);
 
-	// Prints contents of memory buffer to screen
+	// Picks the asset source, the packed bundle if there is one (mapped), otherwise loose PNGs
+	void openAssets(std::string);
+
+	// Imports one asset (GRAPHICS_ASSET_*) from the opened source, reports and returns false if it can't be used
+	bool importAsset(const int);
+
+	// Preallocates the owned gameplay buffers once every asset is imported, returns false if the table backdrop is missing
+	bool finishImport();
+
+	// Rescales conversion ratios and renders the puck, paddle ring and score digit sprites for the current table size, forcing a full redraw
+	void scaleToTable();
+
+	// Prints contents of memory buffer to screen and starts its hold time, doesn't wait for the hold
 	void pushToScreen();
 
-	// Assembles the in-play game image
+	// Reports whether the last presented screen is still within its hold time
+	bool isHolding();
+
+	// Services window events while a held screen stays up
+	void refreshWindow();
+
+	// Assembles the in-play game image, rewriting only the regions that changed since the last one
 	void drawGameplayImage();
 
+	// Reports the camera frame trace behind the last gameplay image
+	FrameTrace getDrawnTrace();
+
 	// Creates the game startup image
 	void drawStartupSplashImage();
 
@@ -31,17 +65,92 @@ public:
 	// Creates a game-won screen for the specified player
 	void drawGamewonImage(const bool);
 
+	// Creates a calibration screen, one marker at the given projected image point on black
+	void drawCalibrationMarker(const Vec2&);
+
 private:
 
+	// table drawn (dimensions, world snapshot and scores)
+	TableState* tableState;
+
+	// table number and the title of its window
+	int tableIndex;
+	std::string windowTitle;
+
+	// Composites the table backdrop, goal boxes and scores into the static layer
+	void buildStaticLayer();
+
+	// Draws the current scores onto the static layer, remembering them
+	void drawScores();
+
+	// Finds the text origin of a player's score
+	cv::Point scoreOrigin(const bool);
+
+	// Finds the screen region a player's score text covers, clipped to the screen
+	cv::Rect scoreRect(const int, const bool);
+
+	// Lays out a number's digit sprites from a text origin, blending them into the static layer if drawing, returns the region covered
+	cv::Rect drawNumber(const int, const cv::Point&, const bool);
+
+	// Checks (debug builds only) that the owned buffers never share an asset's pixels and that a presented asset is unchanged since import
+	void assertAssetsIntact();
+
+	// Hashes an image's pixels row by row (FNV-1a)
+	static uint64_t hashImage(const cv::Mat&);
+
 	// conversion ratios for table-space to screen-space
 	double widthRatio_tableToGraphics;
 	double heightRatio_tableToGraphics;
 
+	// table size the sprites were rendered for
+	double spriteTable_width;
+	double spriteTable_height;
+
+	// pre-rendered moving elements and score digits
+	Sprite puckSprite;
+	Sprite paddleOneSprite;
+	Sprite paddleTwoSprite;
+	Sprite digitSprites[10];
+
 	// time for the next rendered frame to be held on-screen for
 	int currentFrame_holdTime;
 
-	// master memory buffer, staging area for screen image
-	cv::Mat screenBuffer;
+	// time the presented screen's hold ends
+	std::chrono::steady_clock::time_point holdEndTime;
+
+	// camera frame trace behind the last gameplay image
+	FrameTrace drawnTrace;
+
+	// image shown by the next present, the owned gameplay buffer or an asset shown in place (never copied)
+	const cv::Mat* presentedImage;
+
+	// table backdrop with goal boxes and scores, owned and preallocated at import, rebuilt only where a score changes
+	cv::Mat staticLayer;
+
+	// last gameplay image, owned and preallocated at import, kept between frames so only changed regions are rewritten
+	cv::Mat gameplayBuffer;
+
+	// static layer and gameplay buffer hold a composited table (cleared on import and table rescale)
+	bool staticLayerValid;
+
+	// scores drawn on the static layer
+	int shownScore_playerOne;
+	int shownScore_playerTwo;
+
+	// calibration marker screen, owned, allocated on first use
+	cv::Mat calibrationBuffer;
+
+	// regions of the gameplay buffer that differ from the static layer (moving elements, a score change)
+	cv::Rect dirtyRects[GRAPHICS_DIRTY_RECTS];
+	int dirtyRectCount;
+
+	// mapped asset bundle, must outlive the images wrapping its pixels
+	AssetBundle assetBundle;
+
+	// asset source picked by openAssets (directory and separator for loose PNGs)
+	bool assetsBundled;
+	std::string assetPath;
+	std::string assetSeparator;
 
 	// game background/message images, constant after import
 	cv::Mat image_startupSplash;
@@ -51,4 +160,8 @@ private:
 	cv::Mat image_winPlayerOne;
 	cv::Mat image_winPlayerTwo;
 	cv::Mat image_error;
+
+	// assets in name order, and their pixel hashes at import (checked in debug builds)
+	cv::Mat* assets[GRAPHICS_ASSET_COUNT];
+	uint64_t assetHashes[GRAPHICS_ASSET_COUNT];
 };
\ No newline at end of file
@@ -0,0 +1,81 @@
+#include "LatencyHistogram.h"
+
+// Constructor, starts empty
+LatencyHistogram::LatencyHistogram() {
+
+	// zero every bucket
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		counts[i].store(0, std::memory_order_relaxed);
+}
+
+// Copies current bucket counts into an array of HISTOGRAM_BUCKETS entries
+void LatencyHistogram::snapshot(uint64_t* out) const {
+
+	// read each bucket (buckets may advance during the copy, each count is still valid)
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		out[i] = counts[i].load(std::memory_order_relaxed);
+}
+
+// Finds the latency (ns) at a quantile (0-1) of an array of bucket counts, 0 if empty
+double LatencyHistogram::quantile(const uint64_t* buckets, const double q) {
+
+	// check if there are any samples
+	uint64_t samples = total(buckets);
+	if (samples == 0)
+		return 0;
+
+	// rank of the sample at the quantile (1-based)
+	uint64_t rank = static_cast<uint64_t>(ceil(q * samples));
+	if (rank < 1)
+		rank = 1;
+
+	// walk buckets until the rank is reached
+	uint64_t seen = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+		seen += buckets[i];
+		if (seen >= rank)
+			return bucketValue(i);
+	}
+
+	// unreachable, rank never exceeds total
+	return maximum(buckets);
+}
+
+// Finds the largest recorded latency bucket (ns) of an array of bucket counts, 0 if empty
+double LatencyHistogram::maximum(const uint64_t* buckets) {
+
+	// walk down from the top bucket
+	for (int i = HISTOGRAM_BUCKETS - 1; i >= 0; i--)
+		if (buckets[i] != 0)
+			return bucketValue(i);
+
+	// no samples
+	return 0;
+}
+
+// Sums an array of bucket counts
+uint64_t LatencyHistogram::total(const uint64_t* buckets) {
+
+	// add every bucket
+	uint64_t sum = 0;
+	for (int i = 0; i < HISTOGRAM_BUCKETS; i++)
+		sum += buckets[i];
+	return sum;
+}
+
+// Finds the midpoint latency (ns) of a bucket
+double LatencyHistogram::bucketValue(const int index) {
+
+	// small values are exact
+	if (index < HISTOGRAM_SUB_BUCKETS)
+		return index;
+
+	// recover power of two and sub-bucket
+	int exponent = index / HISTOGRAM_SUB_BUCKETS + HISTOGRAM_SUB_BUCKET_BITS - 1;
+	int subBucket = index % HISTOGRAM_SUB_BUCKETS;
+
+	// bucket spans [low, low + width)
+	double width = ldexp(1.0, exponent - HISTOGRAM_SUB_BUCKET_BITS);
+	double low = ldexp(1.0, exponent) + subBucket * width;
+	return low + width / 2;
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include "GameData.h"
+
+// Log-linear (HDR-style) latency histogram in nanoseconds, about 6% bucket precision from 1 ns to hours
+// Lock-free for exactly one recording thread, any thread may take snapshots while it records
+class LatencyHistogram {
+public:
+
+	// Constructor, starts empty
+	LatencyHistogram();
+
+	// Adds one latency sample (ns), only the owning thread may call this
+	void record(const uint64_t value_ns) {
+
+		// single writer, so a relaxed load/store pair is enough (no read-modify-write needed)
+		std::atomic<uint64_t>& bucket = counts[bucketIndex(value_ns)];
+		bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+	}
+
+	// Copies current bucket counts into an array of HISTOGRAM_BUCKETS entries
+	void snapshot(uint64_t*) const;
+
+	// Finds the latency (ns) at a quantile (0-1) of an array of bucket counts, 0 if empty
+	static double quantile(const uint64_t*, const double);
+
+	// Finds the largest recorded latency bucket (ns) of an array of bucket counts, 0 if empty
+	static double maximum(const uint64_t*);
+
+	// Sums an array of bucket counts
+	static uint64_t total(const uint64_t*);
+
+private:
+
+	// Maps a latency (ns) to its bucket, exact below 16 ns then 16 linear sub-buckets per power of two
+	static int bucketIndex(const uint64_t value_ns) {
+
+		// small values get their own bucket
+		if (value_ns < HISTOGRAM_SUB_BUCKETS)
+			return static_cast<int>(value_ns);
+
+		// find highest set bit (power of two the value falls in)
+		int exponent = 63;
+		while (!(value_ns >> exponent))
+			exponent--;
+
+		// top bits below the highest pick the sub-bucket
+		int subBucket = static_cast<int>((value_ns >> (exponent - HISTOGRAM_SUB_BUCKET_BITS)) & (HISTOGRAM_SUB_BUCKETS - 1));
+		return (exponent - HISTOGRAM_SUB_BUCKET_BITS + 1) * HISTOGRAM_SUB_BUCKETS + subBucket;
+	}
+
+	// Finds the midpoint latency (ns) of a bucket
+	static double bucketValue(const int);
+
+	// sample counts per bucket
+	std::atomic<uint64_t> counts[HISTOGRAM_BUCKETS];
+};
@@ -0,0 +1,164 @@
+#include "Metrics.h"
+#include <sstream>
+#include <iomanip>
+
+// check OS, UNIX sockets are POSIX-only
+#ifndef _WIN32
+	#include <sys/socket.h>
+	#include <sys/un.h>
+	#include <unistd.h>
+#endif
+
+// stage names, indexed by STAGE_*
+static const char* stageNames[STAGE_COUNT] = { "capture", "detect", "update_paddles", "tick", "draw", "imshow", "m2p_queue", "m2p_sensor", "m2p_physics", "m2p_render", "m2p_present", "m2p_total", "sensor_wait", "physics_wait" };
+
+// Constructor, no outputs open
+Metrics::Metrics() : previousCounts(STAGE_COUNT * HISTOGRAM_BUCKETS, 0), currentCounts(STAGE_COUNT * HISTOGRAM_BUCKETS, 0) {
+
+	// no socket yet
+	socketHandle = -1;
+
+	// no traces rejected yet
+	traceViolationCount = 0;
+}
+
+// Returns the histogram for a stage (STAGE_*)
+LatencyHistogram& Metrics::stage(const int stageId) {
+
+	// report stage histogram
+	return histograms[stageId];
+}
+
+// Records one camera frame's motion-to-photon breakdown (drawn and presented in steady-clock secs), returns false if its stamps are out of order
+bool Metrics::traceFrame(const FrameTrace& trace, const double drawn, const double presented) {
+
+	// stage boundaries in pipeline order
+	const double times[6] = { trace.captured, trace.taken, trace.published, trace.stepped, drawn, presented };
+
+	// check every stage ends after it starts, reject the trace otherwise (a broken stamp would skew every stage)
+	for (int i = 0; i < 5; i++) {
+		if (times[i + 1] < times[i]) {
+			traceViolationCount++;
+			return false;
+		}
+	}
+
+	// record consecutive stages in nanoseconds
+	for (int i = 0; i < 5; i++)
+		histograms[STAGE_M2P_QUEUE + i].record(static_cast<uint64_t>((times[i + 1] - times[i]) * 1e9));
+
+	// record end-to-end latency
+	histograms[STAGE_M2P_TOTAL].record(static_cast<uint64_t>((presented - trace.captured) * 1e9));
+
+	// report trace accepted
+	return true;
+}
+
+// Reports how many traces had out-of-order stamps
+unsigned long Metrics::getTraceViolationCount() {
+
+	// report count
+	return traceViolationCount;
+}
+
+// Appends every report to a file as one JSON line, returns false if it can't be opened
+bool Metrics::openFile(const std::string& path) {
+
+	// open file for appending
+	file.open(path.c_str(), std::ios::app);
+
+	// report open success
+	return file.good();
+}
+
+// Sends every report as one JSON datagram to a local UNIX socket, returns false if unsupported or it can't be created
+bool Metrics::openSocket(const std::string& path) {
+#ifdef _WIN32
+
+	// report UNIX sockets unsupported
+	return false;
+#else
+
+	// check if path fits a socket address
+	if (path.size() >= sizeof(((sockaddr_un*)0)->sun_path))
+		return false;
+
+	// create datagram socket (reports are sent whole, nothing waits on a reader)
+	socketHandle = socket(AF_UNIX, SOCK_DGRAM, 0);
+	socketPath = path;
+
+	// report creation success
+	return socketHandle >= 0;
+#endif
+}
+
+// Summarizes the stages since the last report, prints it and writes it to any open outputs
+void Metrics::report(const double interval_secs, const std::string& extraFields) {
+
+	// build JSON line and console table side by side
+	std::ostringstream json, console;
+	json << std::fixed << std::setprecision(3) << "{\"interval_s\": " << interval_secs << ", \"stages\": {";
+	console << std::fixed << std::setprecision(1);
+
+	// iterate through stages
+	for (int s = 0; s < STAGE_COUNT; s++) {
+
+		// bucket counts for this stage now and at the last report
+		uint64_t* current = &currentCounts[s * HISTOGRAM_BUCKETS];
+		uint64_t* previous = &previousCounts[s * HISTOGRAM_BUCKETS];
+
+		// snapshot stage, turn running counts into counts since the last report
+		histograms[s].snapshot(current);
+		for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+			uint64_t running = current[i];
+			current[i] -= previous[i];
+			previous[i] = running;
+		}
+
+		// summarize interval in microseconds
+		uint64_t count = LatencyHistogram::total(current);
+		double rate = count / interval_secs;
+		double p50 = LatencyHistogram::quantile(current, 0.5) / 1e3;
+		double p99 = LatencyHistogram::quantile(current, 0.99) / 1e3;
+		double p999 = LatencyHistogram::quantile(current, 0.999) / 1e3;
+		double slowest = LatencyHistogram::maximum(current) / 1e3;
+
+		// append stage to JSON
+		json << (s ? ", " : "") << "\"" << stageNames[s] << "\": {\"count\": " << count << ", \"rate_hz\": " << rate << ", \"p50_us\": " << p50 << ", \"p99_us\": " << p99 << ", \"p999_us\": " << p999 << ", \"max_us\": " << slowest << "}";
+
+		// append stage to console table
+		console << std::left << std::setw(16) << stageNames[s] << std::right << std::setw(8) << rate << "/s  p50 " << std::setw(9) << p50 << "us  p99 " << std::setw(9) << p99 << "us  p999 " << std::setw(9) << p999 << "us  max " << std::setw(9) << slowest << "us" << std::endl;
+	}
+
+	// close JSON, adding caller's fields
+	json << "}" << (extraFields.empty() ? "" : ", ") << extraFields << "}";
+
+	// print table
+	std::cout << console.str();
+
+	// send line to outputs
+	publish(json.str());
+}
+
+// Sends a report line to the file and socket outputs
+void Metrics::publish(const std::string& line) {
+
+	// check if file output is open, append line
+	if (file.is_open())
+		file << line << std::endl;
+
+#ifndef _WIN32
+
+	// check if socket output is open
+	if (socketHandle >= 0) {
+
+		// address listener by path
+		sockaddr_un address = sockaddr_un();
+		address.sun_family = AF_UNIX;
+		strncpy(address.sun_path, socketPath.c_str(), sizeof(address.sun_path) - 1);
+
+		// send without blocking, a missing listener just loses the report
+		sendto(socketHandle, line.c_str(), line.size(), MSG_DONTWAIT, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+	}
+#endif
+}
@@ -0,0 +1,52 @@
+#pragma once
+#include "LatencyHistogram.h"
+#include <vector>
+
+// Per-stage latency registry, each stage's histogram is written by the one thread that runs that stage
+// Reports are built off the hot path by the metrics thread, from the change since the previous report
+class Metrics {
+public:
+
+	// Constructor, no outputs open
+	Metrics();
+
+	// Returns the histogram for a stage (STAGE_*)
+	LatencyHistogram& stage(const int);
+
+	// Records one camera frame's motion-to-photon breakdown (drawn and presented in steady-clock secs), returns false if its stamps are out of order
+	bool traceFrame(const FrameTrace&, const double, const double);
+
+	// Reports how many traces had out-of-order stamps
+	unsigned long getTraceViolationCount();
+
+	// Appends every report to a file as one JSON line, returns false if it can't be opened
+	bool openFile(const std::string&);
+
+	// Sends every report as one JSON datagram to a local UNIX socket, returns false if unsupported or it can't be created
+	bool openSocket(const std::string&);
+
+	// Summarizes the stages since the last report, prints it and writes it to any open outputs
+	void report(const double, const std::string&);
+
+private:
+
+	// Sends a report line to the file and socket outputs
+	void publish(const std::string&);
+
+	// stage histograms
+	LatencyHistogram histograms[STAGE_COUNT];
+
+	// bucket counts at the previous report, and scratch for the current one
+	std::vector<uint64_t> previousCounts;
+	std::vector<uint64_t> currentCounts;
+
+	// number of rejected traces, written by the graphics thread
+	std::atomic<unsigned long> traceViolationCount;
+
+	// optional JSON-lines output file
+	std::ofstream file;
+
+	// optional UNIX datagram socket (-1 when closed) and its destination path
+	int socketHandle;
+	std::string socketPath;
+};
@@ -0,0 +1,93 @@
+#include "PaddleAI.h"
+
+// Constructor, plays the given side (true for paddle one) on the given table with the given constants
+PaddleAI::PaddleAI(const TableState* table, const bool paddleOne, const PhysicsParameters& constants) : tableState(table), isPaddleOne(paddleOne), parameters(constants), predictor(table, constants) {
+
+	// look at the table on the first step
+	sincePlan = PADDLE_AI_REACTION_TIME;
+	intercepting = false;
+	interceptTime = 0;
+}
+
+// Calculates where the paddle moves to over a step (secs), from the start-of-step puck state and the paddle's current position
+Vec2 PaddleAI::steer(const WorldState& world, const Vec2& paddle_position, const double stepDuration_secs) {
+
+	// check if it's time to look at the table again, otherwise keep playing the last plan
+	sincePlan += stepDuration_secs;
+	if (sincePlan >= PADDLE_AI_REACTION_TIME) {
+		plan(world, paddle_position);
+		sincePlan = 0;
+	}
+
+	// check if a shot being met is about to arrive, lunge through where it crosses towards the opponent's goal
+	Vec2 target = plannedTarget;
+	if (intercepting && interceptTime - sincePlan <= PADDLE_AI_STRIKE_TIME)
+		target += strikeDirection * (parameters.puckRadius + PADDLE_RADIUS);
+
+	// move towards target no faster than a player could
+	Vec2 offset = target - paddle_position;
+	double distance = offset.length();
+	double reach = PADDLE_AI_MAX_SPEED * stepDuration_secs;
+	if (distance > reach)
+		target = paddle_position + offset * (reach / distance);
+
+	// keep paddle on the table and in its own half
+	double lowerX = isPaddleOne ? WALL_PADDING_THICKNESS + PADDLE_RADIUS : tableState->table_width / 2 + PADDLE_RADIUS;
+	double upperX = isPaddleOne ? tableState->table_width / 2 - PADDLE_RADIUS : tableState->table_width - WALL_PADDING_THICKNESS - PADDLE_RADIUS;
+	target.x = std::min(std::max(target.x, lowerX), upperX);
+	target.y = std::min(std::max(target.y, WALL_PADDING_THICKNESS + PADDLE_RADIUS), tableState->table_height - WALL_PADDING_THICKNESS - PADDLE_RADIUS);
+	return target;
+}
+
+// Looks at the table and picks where to play until the next look
+void PaddleAI::plan(const WorldState& world, const Vec2& paddle_position) {
+
+	// direction towards the opponent's goal, and the line shots are met on in front of the paddle's own goal
+	const double forward = isPaddleOne ? 1.0 : -1.0;
+	const double defenseX = isPaddleOne ? WALL_PADDING_THICKNESS + PADDLE_AI_DEFENSE_DEPTH * PADDLE_RADIUS : tableState->table_width - WALL_PADDING_THICKNESS - PADDLE_AI_DEFENSE_DEPTH * PADDLE_RADIUS;
+	const Vec2 opponentGoal(isPaddleOne ? tableState->table_width : 0, tableState->table_height / 2);
+
+	// distance between puck and paddle centers when they touch
+	const double contactDistance = parameters.puckRadius + PADDLE_RADIUS;
+
+	// mind the puck nearest the paddle's own goal (the only one outside multi-puck mode)
+	int puck = 0;
+	for (int i = 1; i < world.puck_count; i++)
+		if (forward * world.puck_positions[i].x < forward * world.puck_positions[puck].x)
+			puck = i;
+	const Vec2& puck_position = world.puck_positions[puck];
+	const Vec2& puck_velocity = world.puck_velocities[puck];
+
+	// no shot being met unless one is found below
+	intercepting = false;
+	TrajectoryCrossing crossing;
+
+	// check if puck is heading for the defence line from in front of it, meet it where it will cross (bank shots included)
+	if (forward * puck_velocity.x < 0 && forward * (puck_position.x - defenseX) > 0 && predictor.predictCrossing(puck_position, puck_velocity, defenseX, crossing)) {
+		plannedTarget = crossing.position;
+		intercepting = true;
+		interceptTime = crossing.time;
+		strikeDirection = opponentGoal - crossing.position;
+		strikeDirection = strikeDirection / strikeDirection.length();
+	}
+
+	// check if puck is loose in the paddle's half, strike it towards the opponent's goal
+	else if (forward * (puck_position.x - tableState->table_width / 2) < 0) {
+
+		// calculate direction from the puck to the opponent's goal
+		Vec2 aim = opponentGoal - puck_position;
+		aim = (aim.lengthSquared() > 0) ? aim / aim.length() : Vec2(forward, 0);
+
+		// check if paddle is behind the puck, drive through it
+		if (forward * (paddle_position.x - puck_position.x) < 0)
+			plannedTarget = puck_position - aim * (contactDistance / 2);
+
+		// otherwise circle back behind it on the side the paddle is already on, clear of the puck
+		else
+			plannedTarget = Vec2(puck_position.x - forward * (contactDistance + PADDLE_RADIUS), puck_position.y + (paddle_position.y < puck_position.y ? -contactDistance : contactDistance));
+	}
+
+	// otherwise guard goal, level with the puck within the goal mouth
+	else
+		plannedTarget = Vec2(defenseX, std::min(std::max(puck_position.y, (tableState->table_height - parameters.goalWidth) / 2), (tableState->table_height + parameters.goalWidth) / 2));
+}
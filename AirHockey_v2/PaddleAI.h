@@ -0,0 +1,43 @@
+#pragma once
+#include "GameData.h"
+#include "TrajectoryPredictor.h"
+
+// CPU opponent, moves one paddle from the predicted puck flight instead of the sensor
+// Meets shots at a defence line in front of its goal, strikes a puck left in its half, otherwise guards the goal mouth
+class PaddleAI {
+public:
+
+	// Constructor, plays the given side (true for paddle one) on the given table with the given constants
+	PaddleAI(const TableState*, const bool, const PhysicsParameters& = PhysicsParameters());
+
+	// Calculates where the paddle moves to over a step (secs), from the start-of-step puck state and the paddle's current position
+	Vec2 steer(const WorldState&, const Vec2&, const double);
+
+private:
+
+	// Looks at the table and picks where to play until the next look
+	void plan(const WorldState&, const Vec2&);
+
+	// table the paddle plays on
+	const TableState* tableState;
+
+	// flag for playing paddle one ("left" goal)
+	bool isPaddleOne;
+
+	// constants the table's physics runs with
+	PhysicsParameters parameters;
+
+	// puck flight predictor for the same table and constants
+	TrajectoryPredictor predictor;
+
+	// time (secs) since the last look at the table
+	double sincePlan;
+
+	// where the last look decided to play
+	Vec2 plannedTarget;
+
+	// flag for a shot being met on the defence line, time (secs after the look) it arrives and direction to lunge through it
+	bool intercepting;
+	double interceptTime;
+	Vec2 strikeDirection;
+};
@@ -0,0 +1,83 @@
+#include "PaddleFilter.h"
+
+// Constructor, starts at the origin with no confidence
+PaddleFilter::PaddleFilter() {
+
+	// start stopped at origin
+	reset(Vec2());
+}
+
+// Restarts the filter at a position, stopped and with no confidence
+void PaddleFilter::reset(const Vec2& start) {
+
+	// place paddle, stopped
+	position = start;
+	velocity = Vec2();
+
+	// nothing detected yet
+	confidence = 0;
+}
+
+// Predicts where the paddle will be after the given time (secs)
+Vec2 PaddleFilter::predict(const double deltaTime_secs) {
+
+	// constant-velocity projection
+	return position + velocity * deltaTime_secs;
+}
+
+// Corrects the estimate with a detection made the given time (secs) after the last one
+void PaddleFilter::update(const Vec2& measured, const double deltaTime_secs) {
+
+	// check if the paddle was lost, restart at the detection instead of chasing it (avoids a huge velocity)
+	if (confidence < PADDLE_REACQUIRE_CONFIDENCE) {
+		position = measured;
+		velocity = Vec2();
+		confidence += (1 - confidence) * PADDLE_CONFIDENCE_GAIN;
+		return;
+	}
+
+	// project estimate to the detection time and measure how far off it was
+	Vec2 predicted = predict(deltaTime_secs);
+	Vec2 residual = measured - predicted;
+
+	// blend residual into position and velocity
+	position = predicted + residual * PADDLE_FILTER_ALPHA;
+	velocity += residual * (PADDLE_FILTER_BETA / deltaTime_secs);
+
+	// raise confidence toward one
+	confidence += (1 - confidence) * PADDLE_CONFIDENCE_GAIN;
+}
+
+// Advances the estimate without a detection, decaying velocity and confidence
+void PaddleFilter::coast(const double deltaTime_secs) {
+
+	// keep moving on the last estimate
+	position = predict(deltaTime_secs);
+
+	// slow down so a lost paddle doesn't drift away forever
+	velocity *= PADDLE_COAST_DAMPING;
+
+	// lower confidence toward zero
+	confidence *= (1 - PADDLE_CONFIDENCE_GAIN);
+}
+
+// Reports filtered position
+Vec2 PaddleFilter::getPosition() {
+
+	// report estimate
+	return position;
+}
+
+// Reports filtered velocity
+Vec2 PaddleFilter::getVelocity() {
+
+	// report estimate
+	return velocity;
+}
+
+// Reports detection confidence (0 lost, 1 steadily tracked)
+double PaddleFilter::getConfidence() {
+
+	// report running confidence
+	return confidence;
+}
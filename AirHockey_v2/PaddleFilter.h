@@ -0,0 +1,40 @@
+#pragma once
+#include "GameData.h"
+
+// Alpha-beta tracking filter for one paddle, smooths noisy detections into a position, velocity and confidence
+class PaddleFilter {
+public:
+
+	// Constructor, starts at the origin with no confidence
+	PaddleFilter();
+
+	// Restarts the filter at a position, stopped and with no confidence
+	void reset(const Vec2&);
+
+	// Predicts where the paddle will be after the given time (secs)
+	Vec2 predict(const double);
+
+	// Corrects the estimate with a detection made the given time (secs) after the last one
+	void update(const Vec2&, const double);
+
+	// Advances the estimate without a detection, decaying velocity and confidence
+	void coast(const double);
+
+	// Reports filtered position
+	Vec2 getPosition();
+
+	// Reports filtered velocity
+	Vec2 getVelocity();
+
+	// Reports detection confidence (0 lost, 1 steadily tracked)
+	double getConfidence();
+
+private:
+
+	// filtered paddle state
+	Vec2 position;
+	Vec2 velocity;
+
+	// running measure of how consistently the paddle is being detected
+	double confidence;
+};
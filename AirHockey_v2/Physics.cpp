@@ -1,203 +1,716 @@
 #include "Physics.h"
+#include "PaddleAI.h"
 
 using namespace std;
 
-// Constructor, generates default positions and velocities from table dimensions
-Physics::Physics() {
+// Constructor, racks the given number of pucks (1 outside multi-puck mode) and places paddles on the given table, runs with the given constants
+Physics::Physics(TableState* table, const int puckCount, const PhysicsParameters& constants) : parameters(constants), paddleHitCount(0), opponent(NULL) {
 
-	// default puck position
-	puck_position[0] = table_width / 2;
-	puck_position[1] = table_height / 2;
+	// remember table whose paddles are read and whose world is published
+	tableState = table;
 
-	// default puck velocity (stopped)
-	puck_velocity[0] = 0.0;
-	puck_velocity[1] = 0.0;
+	// keep puck count within the state's storage
+	state.puck_count = min(max(puckCount, 1), PHYSICS_MAX_PUCKS);
+
+	// default puck positions around the table center, stopped
+	rackPucks();
+
+	// no goal yet, resetPuck() moves the first puck
+	scoredPuck = 0;
+
+	// size broadphase so touching pucks always share or border a cell, reserve room for every pair so a crowded table never grows it mid-tick
+	puckGrid.resize(tableState->table_width, tableState->table_height, 2 * parameters.puckRadius);
+	puckPairs.reserve(PHYSICS_MAX_PUCKS * (PHYSICS_MAX_PUCKS - 1) / 2);
 
 	// default paddle positions approximately where real-world paddles should be
-	paddleOne_position[0] = table_width / 4;
-	paddleOne_position[1] = table_height/2;
-	paddleTwo_position[0] = table_width * 3 / 4;
-	paddleTwo_position[1] = table_height / 2;
+	state.paddleOne_position = Vec2(tableState->table_width / 4, tableState->table_height / 2);
+	state.paddleTwo_position = Vec2(tableState->table_width * 3 / 4, tableState->table_height / 2);
+
+	// default paddle velocities (stopped)
+	state.paddleOne_velocity = Vec2();
+	state.paddleTwo_velocity = Vec2();
+
+	// paddles start the first step where they are
+	paddleOne_lastPosition = state.paddleOne_position;
+	paddleTwo_lastPosition = state.paddleTwo_position;
+
+	// no camera frame used yet
+	state.trace = FrameTrace();
+
+	// make default state visible to other threads
+	tableState->world_state.store(state);
 }
 
-// Conducts a full physics iteration (updates puck by velocity, updates paddle velocities)
-void Physics::tick(const long double deltaTime_micros) {
+// Conducts a full physics iteration ending at the given steady-clock time (secs)
+void Physics::tick(const long double deltaTime_micros, const double stepTime_secs) {
+
+	// convert step length to seconds
+	double deltaTime_secs = static_cast<double>(deltaTime_micros * 1e-6);
 
-	// update puck position (multiply velocity by elapsed time)
-	puck_position[0] += puck_velocity[0] * deltaTime_micros * 1e-6;
-	puck_position[1] += puck_velocity[1] * deltaTime_micros * 1e-6;
+	// pull latest paddle snapshot from the sensor
+	updatePaddles(stepTime_secs);
 
-	// transpose puck velocity to polar coords
-	double magnitude = sqrt(pow(puck_velocity[0], 2) + pow(puck_velocity[1], 2));
-	double angle = atan2(puck_velocity[1], puck_velocity[0]);
+	// check if the CPU opponent plays paddle two, move it from the start-of-step puck state instead
+	if (opponent != NULL) {
+		state.paddleTwo_position = opponent->steer(state, paddleTwo_lastPosition, deltaTime_secs);
+		state.paddleTwo_velocity = (state.paddleTwo_position - paddleTwo_lastPosition) / deltaTime_secs;
+	}
 
-	// apply friction force influence opposite to puck velocity
+	// move each puck through the step, resolving wall and paddle contacts at their exact time
+	for (int i = 0; i < state.puck_count; i++)
+		sweepPuck(i, deltaTime_secs);
+
+	// apply friction force influence opposite to puck velocities
 	// or, if velocity is very small, stop the puck
-	if (magnitude > PUCK_FRICTION)
-		magnitude -= (PUCK_FRICTION * deltaTime_micros * 1e-6);
-	else
-		magnitude = 0;
+	applyFriction(state.puck_velocities, state.puck_count, parameters.puckFriction, parameters.puckFriction, deltaTime_secs);
 
-	// transpose coords back to cartesian
-	puck_velocity[0] = magnitude * cos(angle);
-	puck_velocity[1] = magnitude * sin(angle);
+	// iterate through pucks
+	for (int i = 0; i < state.puck_count; i++) {
 
-	// check if applying friction force would invert "horizontal" velocity
-	if (abs(puck_velocity[0]) < (PUCK_FRICTION * deltaTime_micros * 1e-6))
+		// check if applying friction force would invert "horizontal" velocity
+		if (abs(state.puck_velocities[i].x) < (parameters.puckFriction * deltaTime_secs))
 
-		// make zero to prevent direction reversal
-		puck_velocity[0] = 0;
+			// make zero to prevent direction reversal
+			state.puck_velocities[i].x = 0;
 
-	// check if applying friction force would invert "vertical" velocity
-	if (abs(puck_velocity[1]) < (PUCK_FRICTION * deltaTime_micros * 1e-6))
+		// check if applying friction force would invert "vertical" velocity
+		if (abs(state.puck_velocities[i].y) < (parameters.puckFriction * deltaTime_secs))
 
-		// make zero to prevent direction reversal
-		puck_velocity[1] = 0;
+			// make zero to prevent direction reversal
+			state.puck_velocities[i].y = 0;
+	}
+
+	// check if more than one puck is in play, bounce pucks off each other
+	if (state.puck_count > 1)
+		resolvePuckContacts();
 
-	// deal with interactions
+	// deal with any remaining overlaps
 	handleCollisions();
+
+	// make updated state visible to other threads
+	tableState->world_state.store(state);
 }
 
-// Handles puck bouncing off of paddles and walls, accounts for (but doesn't handle) goals
+// Handles pucks bouncing off of paddles and walls, accounts for (but doesn't handle) goals
 void Physics::handleCollisions() {
 
-	// make sure interaction is not a goal
-	if (puck_position[1] > (table_height + GOAL_WIDTH) / 2 || puck_position[1] < (table_height - GOAL_WIDTH) / 2) {
+	// iterate through pucks
+	for (int i = 0; i < state.puck_count; i++) {
 
-		// check if puck has collided with a "vertical" wall
-		if (puck_position[0] <= PUCK_RADIUS + WALL_PADDING_THICKNESS || puck_position[0] >= (table_width - PUCK_RADIUS - WALL_PADDING_THICKNESS)) {
+		// create references for puck position and velocity
+		Vec2& puck_position = state.puck_positions[i];
+		Vec2& puck_velocity = state.puck_velocities[i];
 
-			// invert "horizontal" velocity, attenuate by elasticity
-			puck_velocity[0] *= (-1.0 * WALL_ELASTICITY);
+		// make sure interaction is not a goal
+		if (puck_position.y > (tableState->table_height + parameters.goalWidth) / 2 || puck_position.y < (tableState->table_height - parameters.goalWidth) / 2) {
 
-			// detect which wall puck intersects with
-			if (puck_position[0] <= PUCK_RADIUS + WALL_PADDING_THICKNESS)
+			// check if puck has pushed into a "vertical" wall (one resting exactly against it was already bounced by the sweep)
+			if (puck_position.x < parameters.puckRadius + WALL_PADDING_THICKNESS || puck_position.x > (tableState->table_width - parameters.puckRadius - WALL_PADDING_THICKNESS)) {
 
-				// for "left" wall, move puck out of wall
-				puck_position[0] = PUCK_RADIUS + 1 + WALL_PADDING_THICKNESS;
-			else
+				// invert "horizontal" velocity, attenuate by elasticity
+				puck_velocity.x *= (-1.0 * parameters.wallElasticity);
+
+				// detect which wall puck intersects with
+				if (puck_position.x < parameters.puckRadius + WALL_PADDING_THICKNESS)
+
+					// for "left" wall, move puck out of wall
+					puck_position.x = parameters.puckRadius + 1 + WALL_PADDING_THICKNESS;
+				else
+
+					// for "right" wall, move puck out of wall
+					puck_position.x = tableState->table_width - parameters.puckRadius - 1 - WALL_PADDING_THICKNESS;
+			}
+
+			// check if puck has pushed into a "horizontal" wall
+			if (puck_position.y < parameters.puckRadius + WALL_PADDING_THICKNESS || puck_position.y > (tableState->table_height - parameters.puckRadius - WALL_PADDING_THICKNESS)) {
+
+				// invert "vertical" velocity, attenuate by elasticity
+				puck_velocity.y *= (-1.0 * parameters.wallElasticity);
+
+				// detect which wall puck intersects with
+				if (puck_position.y < parameters.puckRadius + WALL_PADDING_THICKNESS)
 
-				// for "right" wall, move puck out of wall
-				puck_position[0] = table_width - PUCK_RADIUS - 1 - WALL_PADDING_THICKNESS;
+					// for "top" wall, move puck out of wall
+					puck_position.y = parameters.puckRadius + 1 + WALL_PADDING_THICKNESS;
+				else
+
+					// for "bottom" wall, move puck out of wall
+					puck_position.y = tableState->table_height - parameters.puckRadius - 1 - WALL_PADDING_THICKNESS;
+			}
 		}
 
-		// check if puck has collided with a "horizontal" wall
-		if (puck_position[1] <= PUCK_RADIUS + WALL_PADDING_THICKNESS || puck_position[1] >= (table_height - PUCK_RADIUS - WALL_PADDING_THICKNESS)) {
+		// check both paddles, a puck wedged between them is pushed out of each
+		for (int p = 0; p < 2; p++) {
+
+			// check for puck collision with this paddle
+			bool isPaddleOne = (p == 0);
+			if (!hasCollision(i, isPaddleOne))
+				continue;
+
+			// create references for paddle position and velocity
+			const Vec2& paddle_position = isPaddleOne ? state.paddleOne_position : state.paddleTwo_position;
+			const Vec2& paddle_velocity = isPaddleOne ? state.paddleOne_velocity : state.paddleTwo_velocity;
+
+			// calculate the unit vector from the paddle to the puck
+			Vec2 collisionNormal = puck_position - paddle_position;
+			double separation = collisionNormal.length();
+			collisionNormal = (separation > 0) ? collisionNormal / separation : Vec2(0, 1);
+
+			// check if puck is moving towards the paddle, bounce puck off of paddle
+			if ((puck_velocity - paddle_velocity).dot(collisionNormal) < 0) {
+				bouncePuck(i, paddle_position, paddle_velocity);
+				paddleHitCount++;
+			}
+
+			// move puck out of the paddle in one step
+			depenetratePuck(i, paddle_position);
+		}
+	}
+}
+
+// Reflects a puck's velocity off of a paddle touching it at the given position
+void Physics::bouncePuck(const int puck, const Vec2& paddle_position, const Vec2& paddle_velocity) {
+
+	// create references for puck position and velocity
+	Vec2& puck_position = state.puck_positions[puck];
+	Vec2& puck_velocity = state.puck_velocities[puck];
+
+	// calculate the unit vector from the paddle to the puck
+	Vec2 collisionNormal = puck_position - paddle_position;
+	double separation = collisionNormal.length();
+
+	// check for degenerate (concentric) contact, no meaningful normal to bounce off
+	if (separation <= 0)
+		return;
+
+	// mirror the puck velocity (relative to the paddle) across the contact plane
+	puck_velocity = (puck_velocity - paddle_velocity).reflect(collisionNormal / separation) + paddle_velocity;
+}
+
+// Moves a puck out of the given paddle in one step, sliding it along a wall if the paddle pins it there
+void Physics::depenetratePuck(const int puck, const Vec2& paddle_position) {
+
+	// create reference for puck position
+	Vec2& puck_position = state.puck_positions[puck];
+
+	// distance between centers once the puck is clear of the paddle
+	const double contactDistance = parameters.puckRadius + PADDLE_RADIUS + CONTACT_SEPARATION;
+
+	// calculate limits for the puck center imposed by the walls
+	const Vec2 lowerLimit(parameters.puckRadius + WALL_PADDING_THICKNESS, parameters.puckRadius + WALL_PADDING_THICKNESS);
+	const Vec2 upperLimit(tableState->table_width - parameters.puckRadius - WALL_PADDING_THICKNESS, tableState->table_height - parameters.puckRadius - WALL_PADDING_THICKNESS);
+
+	// check if puck is already clear of the paddle
+	Vec2 offset = puck_position - paddle_position;
+	double separation = offset.length();
+	if (separation >= contactDistance)
+		return;
+
+	// calculate direction to push puck, towards table center if puck and paddle are concentric
+	Vec2 pushDirection = (separation > 0) ? offset / separation : Vec2(tableState->table_width / 2, tableState->table_height / 2) - paddle_position;
+	if (separation <= 0)
+		pushDirection = (pushDirection.lengthSquared() > 0) ? pushDirection / pushDirection.length() : Vec2(0, 1);
+
+	// push puck straight out to contact distance
+	puck_position = paddle_position + pushDirection * contactDistance;
+
+	// check each axis for a wall the push drove the puck into
+	for (int i = 0; i < 2; i++) {
+
+		// "vertical" walls are open across the goal mouths
+		if (i == 0 && puck_position.y <= (tableState->table_height + parameters.goalWidth) / 2 && puck_position.y >= (tableState->table_height - parameters.goalWidth) / 2)
+			continue;
+
+		// find wall the puck was pushed through, if any
+		double wall;
+		if (puck_position[i] < lowerLimit[i])
+			wall = lowerLimit[i];
+		else if (puck_position[i] > upperLimit[i])
+			wall = upperLimit[i];
+		else
+			continue;
+
+		// pin puck against the wall
+		puck_position[i] = wall;
+
+		// calculate how far along the wall the puck must sit to clear the paddle
+		int j = 1 - i;
+		double reachSquared = contactDistance * contactDistance - (wall - paddle_position[i]) * (wall - paddle_position[i]);
+
+		// check if the paddle still overlaps the pinned puck
+		if (reachSquared > 0) {
+
+			// slide puck along the wall on the side it was already on
+			double side = (puck_position[j] >= paddle_position[j]) ? 1.0 : -1.0;
+			puck_position[j] = paddle_position[j] + side * sqrt(reachSquared);
+
+			// check if that side is blocked by the adjoining wall, use the other side
+			if (puck_position[j] < lowerLimit[j] || puck_position[j] > upperLimit[j])
+				puck_position[j] = paddle_position[j] - side * sqrt(reachSquared);
+		}
+
+		// keep puck on the table (a paddle in a corner can't be fully cleared)
+		puck_position[j] = min(max(puck_position[j], lowerLimit[j]), upperLimit[j]);
+	}
+}
+
+// Advances a puck through a step, stopping at each wall or paddle contact to resolve it
+void Physics::sweepPuck(const int puck, const double deltaTime_secs) {
+
+	// create references for puck position and velocity
+	Vec2& puck_position = state.puck_positions[puck];
+	Vec2& puck_velocity = state.puck_velocities[puck];
+
+	// paddles are swept linearly from their last positions to their current positions across the step
+	Vec2 paddleOne_sweepVelocity = (state.paddleOne_position - paddleOne_lastPosition) / deltaTime_secs;
+	Vec2 paddleTwo_sweepVelocity = (state.paddleTwo_position - paddleTwo_lastPosition) / deltaTime_secs;
+
+	// time already simulated within this step
+	double elapsed = 0;
+
+	// flags for paddles that have already been hit this step
+	bool paddleOne_resolved = false;
+	bool paddleTwo_resolved = false;
+
+	// resolve contacts in time order, up to the per-step limit
+	for (int contacts = 0; contacts < PHYSICS_MAX_SWEEP_CONTACTS && elapsed < deltaTime_secs; contacts++) {
+
+		// calculate time left in the step
+		double remaining = deltaTime_secs - elapsed;
+
+		// find earliest contact within the remaining time
+		int contact = CONTACT_NONE;
+		double timeOfImpact = remaining;
+		double candidateTime;
+		int wallAxis;
+
+		// check walls
+		if (sweepWalls(puck, timeOfImpact, candidateTime, wallAxis)) {
+			timeOfImpact = candidateTime;
+			contact = (wallAxis == 0) ? CONTACT_WALL_VERTICAL : CONTACT_WALL_HORIZONTAL;
+		}
+
+		// check paddle one
+		if (!paddleOne_resolved && sweepPaddle(puck, paddleOne_lastPosition + paddleOne_sweepVelocity * elapsed, paddleOne_sweepVelocity, timeOfImpact, candidateTime)) {
+			timeOfImpact = candidateTime;
+			contact = CONTACT_PADDLE_ONE;
+		}
+
+		// check paddle two
+		if (!paddleTwo_resolved && sweepPaddle(puck, paddleTwo_lastPosition + paddleTwo_sweepVelocity * elapsed, paddleTwo_sweepVelocity, timeOfImpact, candidateTime)) {
+			timeOfImpact = candidateTime;
+			contact = CONTACT_PADDLE_TWO;
+		}
+
+		// advance puck to the contact (or the end of the step)
+		advanceBodies(&puck_position, &puck_velocity, 1, timeOfImpact);
+		elapsed += timeOfImpact;
+
+		// check if the step finished without contact
+		if (contact == CONTACT_NONE)
+			return;
+
+		// check if puck hit a "vertical" wall
+		if (contact == CONTACT_WALL_VERTICAL) {
+
+			// place puck exactly against the wall it hit, told by the velocity before the bounce (a fully inelastic wall leaves none)
+			puck_position.x = (puck_velocity.x < 0) ? parameters.puckRadius + WALL_PADDING_THICKNESS : tableState->table_width - parameters.puckRadius - WALL_PADDING_THICKNESS;
+
+			// invert "horizontal" velocity, attenuate by elasticity
+			puck_velocity.x *= (-1.0 * parameters.wallElasticity);
+		}
+
+		// check if puck hit a "horizontal" wall
+		else if (contact == CONTACT_WALL_HORIZONTAL) {
+
+			// place puck exactly against the wall it hit, told by the velocity before the bounce
+			puck_position.y = (puck_velocity.y < 0) ? parameters.puckRadius + WALL_PADDING_THICKNESS : tableState->table_height - parameters.puckRadius - WALL_PADDING_THICKNESS;
 
 			// invert "vertical" velocity, attenuate by elasticity
-			puck_velocity[1] *= (-1.0 * WALL_ELASTICITY);
+			puck_velocity.y *= (-1.0 * parameters.wallElasticity);
+		}
 
-			// detect which wall puck intersects with
-			if (puck_position[1] <= PUCK_RADIUS + WALL_PADDING_THICKNESS)
+		// otherwise puck hit a paddle
+		else {
 
-				// for "top" wall, move puck out of wall
-				puck_position[1] = PUCK_RADIUS + 1 + WALL_PADDING_THICKNESS;
-			else
+			// select paddle that was hit
+			bool isPaddleOne = (contact == CONTACT_PADDLE_ONE);
+
+			// calculate paddle position at the moment of contact
+			Vec2 paddle_position = isPaddleOne ? paddleOne_lastPosition + paddleOne_sweepVelocity * elapsed : paddleTwo_lastPosition + paddleTwo_sweepVelocity * elapsed;
+
+			// bounce puck off of paddle using the sensed paddle velocity
+			bouncePuck(puck, paddle_position, isPaddleOne ? state.paddleOne_velocity : state.paddleTwo_velocity);
+			paddleHitCount++;
 
-				// for "bottom" wall, move puck out of wall
-				puck_position[1] = table_height - PUCK_RADIUS - 1 - WALL_PADDING_THICKNESS;
+			// make sure puck is clear of the paddle
+			depenetratePuck(puck, paddle_position);
+
+			// each paddle is hit at most once per step, handleCollisions() pushes out any later overlap
+			if (isPaddleOne)
+				paddleOne_resolved = true;
+			else
+				paddleTwo_resolved = true;
 		}
 	}
 
-	// create arrays for paddle position, velocity and index
-	double* paddle_position;
-	double* paddle_velocity;
-	bool isPaddleOne;
+	// contact limit reached, move puck through whatever time is left
+	advanceBodies(&puck_position, &puck_velocity, 1, deltaTime_secs - elapsed);
+}
 
-	// check for puck collision with player one paddle
-	if (hasCollision(true)) {
+// Finds the earliest time a puck touches a wall, skipping the goal mouths, returns false if none within maxTime
+bool Physics::sweepWalls(const int puck, const double maxTime, double& timeOfImpact, int& axis) {
+
+	// create references for puck position and velocity
+	const Vec2& puck_position = state.puck_positions[puck];
+	const Vec2& puck_velocity = state.puck_velocities[puck];
+
+	// calculate limits for the puck center imposed by the walls
+	const Vec2 lowerLimit(parameters.puckRadius + WALL_PADDING_THICKNESS, parameters.puckRadius + WALL_PADDING_THICKNESS);
+	const Vec2 upperLimit(tableState->table_width - parameters.puckRadius - WALL_PADDING_THICKNESS, tableState->table_height - parameters.puckRadius - WALL_PADDING_THICKNESS);
+
+	// initialize earliest contact
+	bool found = false;
+	timeOfImpact = maxTime;
+
+	// check "vertical" walls (axis 0) and "horizontal" walls (axis 1)
+	for (int i = 0; i < 2; i++) {
+
+		// calculate time until puck reaches the wall it is moving towards
+		double time;
+		if (puck_velocity[i] < 0 && puck_position[i] >= lowerLimit[i])
+			time = (lowerLimit[i] - puck_position[i]) / puck_velocity[i];
+		else if (puck_velocity[i] > 0 && puck_position[i] <= upperLimit[i])
+			time = (upperLimit[i] - puck_position[i]) / puck_velocity[i];
+		else
+			continue;
+
+		// check if contact is later than one already found
+		if (time > timeOfImpact)
+			continue;
+
+		// check if a "vertical" wall contact is actually in a goal mouth
+		if (i == 0) {
+			double contactHeight = puck_position.y + puck_velocity.y * time;
+			if (contactHeight <= (tableState->table_height + parameters.goalWidth) / 2 && contactHeight >= (tableState->table_height - parameters.goalWidth) / 2)
+				continue;
+		}
 
-		// assign paddle one position, velocity and index as collision object
-		paddle_position = paddleOne_position;
-		paddle_velocity = paddleOne_velocity;
-		isPaddleOne = true;
+		// record as new earliest contact
+		timeOfImpact = time;
+		axis = i;
+		found = true;
 	}
 
-	// check for puck collision with player two paddle
-	else if (hasCollision(false)) {
+	// report whether a contact was found
+	return found;
+}
+
+// Finds the earliest time a puck touches a moving paddle, returns false if none within maxTime
+bool Physics::sweepPaddle(const int puck, const Vec2& paddle_position, const Vec2& paddle_sweepVelocity, const double maxTime, double& timeOfImpact) {
 
-		// assign paddle one position, velocity and index as collision object
-		paddle_position = paddleTwo_position;
-		paddle_velocity = paddleTwo_velocity;
-		isPaddleOne = false;
+	// create references for puck position and velocity
+	const Vec2& puck_position = state.puck_positions[puck];
+	const Vec2& puck_velocity = state.puck_velocities[puck];
+
+	// calculate puck offset and velocity relative to the paddle
+	Vec2 offset = puck_position - paddle_position;
+	Vec2 relativeVelocity = puck_velocity - paddle_sweepVelocity;
+
+	// coefficients of |offset + relativeVelocity * t|^2 = (puck radius + PADDLE_RADIUS)^2 (half-b form)
+	double a = relativeVelocity.lengthSquared();
+	double b = offset.dot(relativeVelocity);
+	double c = offset.lengthSquared() - (parameters.puckRadius + PADDLE_RADIUS) * (parameters.puckRadius + PADDLE_RADIUS);
+
+	// check if puck and paddle are separating (or not moving relative to each other)
+	if (b >= 0)
+		return false;
+
+	// check if already touching while approaching, report immediate contact
+	if (c <= 0) {
+		timeOfImpact = 0;
+		return true;
 	}
 
-	// if no collision was detected, handleCollisions() is done, so stop
-	else
-		return;
+	// check if paths never come within contact distance
+	double discriminant = b * b - a * c;
+	if (discriminant < 0)
+		return false;
+
+	// calculate first time of contact
+	double time = (-b - sqrt(discriminant)) / a;
+
+	// check if contact happens within the allowed time
+	if (time > maxTime)
+		return false;
+
+	// report contact
+	timeOfImpact = time;
+	return true;
+}
 
-	// calculate the position vector between the puck and the paddle
-	double collisionNormal = atan2(puck_position[1] - paddle_position[1], puck_position[0] - paddle_position[0]);
+// Bounces and separates touching pucks, pairs found by the grid broadphase
+void Physics::resolvePuckContacts() {
 
-	// calculate the impulse vector of the collision
-	double collisionHeading = atan2(paddle_velocity[1] - puck_velocity[1], paddle_velocity[0] - puck_velocity[0]);
+	// distance between centers of touching pucks
+	const double contactDistance = 2 * parameters.puckRadius;
 
-	// calculate the magnitude of force resulting from the interaction
-	double magnitudeOfInteraction = sqrt(pow(puck_velocity[0] - paddle_velocity[0], 2) + pow(puck_velocity[1] - paddle_velocity[1], 2));
+	// bin pucks into cells, list pucks in the same or bordering cells (only those can touch)
+	puckGrid.build(state.puck_positions, state.puck_count);
+	puckGrid.findPairs(puckPairs);
 
-	// calculate the resulting velocity vector of the puck
-	double bounceHeading = collisionNormal + (collisionNormal - collisionHeading);
+	// iterate through candidate pairs (pucks are checked at step ends, a puck moves well under its radius per step)
+	for (size_t p = 0; p < puckPairs.size(); p++) {
 
-	// transpose resulting vector from polar to cartesian
-	puck_velocity[0] = magnitudeOfInteraction * cos(bounceHeading) + paddle_velocity[0];
-	puck_velocity[1] = magnitudeOfInteraction * sin(bounceHeading) + paddle_velocity[1];
+		// create references for both pucks
+		Vec2& first_position = state.puck_positions[puckPairs[p].first];
+		Vec2& first_velocity = state.puck_velocities[puckPairs[p].first];
+		Vec2& second_position = state.puck_positions[puckPairs[p].second];
+		Vec2& second_velocity = state.puck_velocities[puckPairs[p].second];
 
-	// determine if puck intersects with paddle
-	while (hasCollision(isPaddleOne)) {
+		// check if the pucks overlap
+		Vec2 offset = second_position - first_position;
+		double separationSquared = offset.lengthSquared();
+		if (separationSquared >= contactDistance * contactDistance)
+			continue;
 
-		// move puck along resultant vector until it no longer intersects
-		puck_position[0] += cos(collisionNormal);
-		puck_position[1] += sin(collisionNormal);
+		// calculate the unit vector from the first puck to the second, any direction if concentric
+		double separation = sqrt(separationSquared);
+		Vec2 collisionNormal = (separation > 0) ? offset / separation : Vec2(1, 0);
+
+		// check if pucks are moving towards each other
+		double approachSpeed = (second_velocity - first_velocity).dot(collisionNormal);
+		if (approachSpeed < 0) {
+
+			// equal masses, exchange the normal impulse attenuated by elasticity
+			Vec2 impulse = collisionNormal * (-(1.0 + PUCK_ELASTICITY) * approachSpeed / 2);
+			first_velocity -= impulse;
+			second_velocity += impulse;
+		}
+
+		// push pucks apart equally to contact distance (walls and paddles are enforced afterwards)
+		Vec2 push = collisionNormal * ((contactDistance + CONTACT_SEPARATION - separation) / 2);
+		first_position -= push;
+		second_position += push;
 	}
 }
 
-// Determines whether the puck intersects with the specified paddle
-bool Physics::hasCollision(const bool isPaddleOne) {
+// Determines whether a puck intersects with the specified paddle
+bool Physics::hasCollision(const int puck, const bool isPaddleOne) {
+
+	// create reference for puck position
+	const Vec2& puck_position = state.puck_positions[puck];
 
 	// check which paddle was requested
 	if(isPaddleOne)
 
 		// check for puck intersection with paddle one
-		return (sqrt(pow(puck_position[0] - paddleOne_position[0], 2) + pow(puck_position[1] - paddleOne_position[1], 2)) <= (PUCK_RADIUS + PADDLE_RADIUS));
+		return ((puck_position - state.paddleOne_position).lengthSquared() <= (parameters.puckRadius + PADDLE_RADIUS) * (parameters.puckRadius + PADDLE_RADIUS));
 	else
 
 		// check for puck intersection with paddle two
-		return (sqrt(pow(puck_position[0] - paddleTwo_position[0], 2) + pow(puck_position[1] - paddleTwo_position[1], 2)) <= (PUCK_RADIUS + PADDLE_RADIUS));
+		return ((puck_position - state.paddleTwo_position).lengthSquared() <= (parameters.puckRadius + PADDLE_RADIUS) * (parameters.puckRadius + PADDLE_RADIUS));
 }
 
-// Determines whether the puck is in a goal
+// Determines whether a puck is in a goal, remembering which one scored
 int Physics::detectGoals() {
 
-	// check if the puck has a non-viable "vertical" coordinate
-	if (puck_position[1] > (table_height + GOAL_WIDTH) / 2 || puck_position[1] < (table_height - GOAL_WIDTH) / 2)
+	// iterate through pucks
+	for (int i = 0; i < state.puck_count; i++) {
 
-		// report no goal
-		return 0;
+		// create reference for puck position
+		const Vec2& puck_position = state.puck_positions[i];
 
-	// check if puck intersects with "left" goal
-	if (puck_position[0] <= (WALL_PADDING_THICKNESS - PUCK_RADIUS))
+		// check if the puck has a non-viable "vertical" coordinate
+		if (puck_position.y > (tableState->table_height + parameters.goalWidth) / 2 || puck_position.y < (tableState->table_height - parameters.goalWidth) / 2)
 
-		// report player two goal
-		return 2;
+			// no goal from this puck
+			continue;
 
-	// check if puck intersects with "right" goal
-	if (puck_position[0] >= table_width - (WALL_PADDING_THICKNESS - PUCK_RADIUS))
+		// check if puck intersects with "left" goal
+		if (puck_position.x <= (WALL_PADDING_THICKNESS - parameters.puckRadius)) {
 
-		// report player one goal
-		return 1;
+			// report player two goal
+			scoredPuck = i;
+			return 2;
+		}
+
+		// check if puck intersects with "right" goal
+		if (puck_position.x >= tableState->table_width - (WALL_PADDING_THICKNESS - parameters.puckRadius)) {
+
+			// report player one goal
+			scoredPuck = i;
+			return 1;
+		}
+	}
 
 	// report no goal
 	return 0;
 }
 
-// returns the puck to the given location and stops puck
+// Checks for goals, updates the table's scores and gameState accordingly, returns the player who scored (0 if none)
+int Physics::scoreGoals() {
+
+	// check which goal (if any) the puck is in
+	int goal = detectGoals();
+
+	// check if player one scored a goal
+	if (goal == 1) {
+
+		// increment score, check if player won game
+		if (++tableState->score_playerOne >= WINNING_SCORE) {
+
+			// change game state
+			tableState->gameState = WIN_ONE;
+
+			// reset scores for new game
+			tableState->score_playerOne = 0;
+			tableState->score_playerTwo = 0;
+
+			// reset puck to middle
+			resetPuck(tableState->table_center);
+		}
+		else {
+
+			// change game state
+			tableState->gameState = GOAL_ONE;
+
+			// reset puck to player two's side
+			resetPuck(tableState->table_centerRight);
+		}
+	}
+
+	// check if player two scored a goal
+	else if (goal == 2) {
+
+		// increment score, check if player won game
+		if (++tableState->score_playerTwo >= WINNING_SCORE) {
+
+			// change game state
+			tableState->gameState = WIN_TWO;
+
+			// reset scores for new game
+			tableState->score_playerOne = 0;
+			tableState->score_playerTwo = 0;
+
+			// reset puck to middle
+			resetPuck(tableState->table_center);
+		}
+		else {
+
+			// change game state
+			tableState->gameState = GOAL_TWO;
+
+			// reset puck to player ones side
+			resetPuck(tableState->table_centerLeft);
+		}
+	}
+
+	// report scoring player
+	return goal;
+}
+
+// returns the puck that last scored (the first puck before any goal) to the given location and stops it
 void Physics::resetPuck(const double* new_position) {
 
 	// update puck position to new coords
-	puck_position[0] = new_position[0];
-	puck_position[1] = new_position[1];
+	state.puck_positions[scoredPuck] = Vec2(new_position[0], new_position[1]);
 
 	// make puck velocity vector zero
-	puck_velocity[0] = 0.0;
-	puck_velocity[1] = 0.0;
-}
\ No newline at end of file
+	state.puck_velocities[scoredPuck] = Vec2();
+
+	// make updated state visible to other threads
+	tableState->world_state.store(state);
+}
+
+// places a puck at the given location with the given velocity
+void Physics::launchPuck(const int puck, const Vec2& new_position, const Vec2& new_velocity) {
+
+	// update puck position and velocity
+	state.puck_positions[puck] = new_position;
+	state.puck_velocities[puck] = new_velocity;
+
+	// make updated state visible to other threads
+	tableState->world_state.store(state);
+}
+
+// Spreads the pucks over the middle of the table in a grid, stopped
+void Physics::rackPucks() {
+
+	// distance between neighbouring puck centers
+	const double spacing = 2 * parameters.puckRadius + PUCK_RACK_GAP;
+
+	// fit as many rows between the "horizontal" walls as there is room for, then enough columns for every puck
+	int rows = min(state.puck_count, static_cast<int>((tableState->table_height - 2 * (parameters.puckRadius + WALL_PADDING_THICKNESS)) / spacing) + 1);
+	rows = max(rows, 1);
+	int columns = (state.puck_count + rows - 1) / rows;
+
+	// iterate through pucks, filling columns from the table center outwards (a single puck sits on the center)
+	for (int i = 0; i < state.puck_count; i++) {
+		double column = (i / rows) - (columns - 1) / 2.0;
+		double row = (i % rows) - (rows - 1) / 2.0;
+		state.puck_positions[i] = Vec2(tableState->table_width / 2 + column * spacing, tableState->table_height / 2 + row * spacing);
+		state.puck_velocities[i] = Vec2();
+	}
+
+	// make updated state visible to other threads
+	tableState->world_state.store(state);
+}
+
+// Returns the physics state as of the last step (only safe from the thread stepping physics)
+const WorldState& Physics::getState() {
+
+	// expose owned state directly, no copy
+	return state;
+}
+
+// Returns the constants this physics runs with
+const PhysicsParameters& Physics::getParameters() {
+
+	// expose constants
+	return parameters;
+}
+
+// Reports how many times pucks have bounced off a paddle
+unsigned long Physics::getPaddleHitCount() {
+
+	// report running total
+	return paddleHitCount;
+}
+
+// Drives paddle two from the given CPU opponent instead of the sensor (NULL hands it back to the sensor)
+void Physics::setOpponent(PaddleAI* cpuOpponent) {
+
+	// remember opponent, used from the next step
+	opponent = cpuOpponent;
+}
+
+// Copies the latest published paddles into the physics state, extrapolated to the given steady-clock time (secs)
+void Physics::updatePaddles(const double stepTime_secs) {
+
+	// read a consistent paddle snapshot
+	PaddleState paddles = tableState->paddle_state.load();
+
+	// remember where paddles were at the start of the step for sweeping
+	paddleOne_lastPosition = state.paddleOne_position;
+	paddleTwo_lastPosition = state.paddleTwo_position;
+
+	// time from the camera frame to the end of this step, capped so a stalled sensor doesn't fling paddles
+	double horizon = min(max(stepTime_secs - paddles.trace.captured, 0.0), PADDLE_MAX_EXTRAPOLATION);
+
+	// project confidently tracked paddles forward to the step time to hide camera latency
+	double horizonOne = paddles.paddleOne_confidence >= PADDLE_MIN_CONFIDENCE ? horizon : 0;
+	double horizonTwo = paddles.paddleTwo_confidence >= PADDLE_MIN_CONFIDENCE ? horizon : 0;
+
+	// copy paddle positions and velocities into physics state
+	state.paddleOne_position = paddles.paddleOne_position + paddles.paddleOne_velocity * horizonOne;
+	state.paddleOne_velocity = paddles.paddleOne_velocity;
+	state.paddleTwo_position = paddles.paddleTwo_position + paddles.paddleTwo_velocity * horizonTwo;
+	state.paddleTwo_velocity = paddles.paddleTwo_velocity;
+
+	// check if estimates come from a new camera frame, carry its trace forward stamped with when this step consumed it
+	if (paddles.trace.captured != state.trace.captured) {
+		state.trace = paddles.trace;
+		state.trace.stepped = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	}
+}
@@ -1,27 +1,115 @@
 #pragma once
 #include "GameData.h"
+#include "SpatialGrid.h"
 
 using namespace std;
 
+// CPU opponent (PaddleAI.h includes this header)
+class PaddleAI;
+
+// Physics constants one table runs with, defaults are the compiled-in values so only headless sweeps change them
+struct PhysicsParameters {
+
+	// Constructor, compiled-in values
+	PhysicsParameters() : wallElasticity(WALL_ELASTICITY), puckFriction(PUCK_FRICTION), puckRadius(PUCK_RADIUS), goalWidth(GOAL_WIDTH) {}
+
+	double wallElasticity;	// coefficient of energy conserved during a wall collision
+	double puckFriction;	// units per sec of deceleration
+	double puckRadius;		// radius of every puck
+	double goalWidth;		// width of both goal mouths
+};
+
 // Physics handling class, processes velocity incrementation and collisions, detects goals
 class Physics {
 public:
 
-	// Constructor, generates default positions and velocities from table dimensions
-	Physics();
+	// Constructor, racks the given number of pucks (1 outside multi-puck mode) and places paddles on the given table, runs with the given constants
+	Physics(TableState*, const int = 1, const PhysicsParameters& = PhysicsParameters());
 
-	// Conducts a full physics iteration (updates puck by velocity, updates paddle velocities)
-	void tick(const long double);
+	// Conducts a full physics iteration ending at the given steady-clock time (secs)
+	void tick(const long double, const double);
 
-	// Handles puck bouncing off of paddles and walls, accounts for (but doesn't handle) goals
+	// Handles pucks bouncing off of paddles and walls, accounts for (but doesn't handle) goals
 	void handleCollisions();
 
-	// Determines whether the puck intersects with the specified paddle
-	bool hasCollision(const bool);
+	// Reflects a puck's velocity off of a paddle touching it at the given position
+	void bouncePuck(const int, const Vec2&, const Vec2&);
 
-	// Determines whether the puck is in a goal
+	// Determines whether a puck intersects with the specified paddle
+	bool hasCollision(const int, const bool);
+
+	// Determines whether a puck is in a goal, remembering which one scored
 	int detectGoals();
 
-	// returns the puck to the given location and stops puck
+	// Checks for goals, updates the table's scores and gameState accordingly, returns the player who scored (0 if none)
+	int scoreGoals();
+
+	// returns the puck that last scored (the first puck before any goal) to the given location and stops it
 	void resetPuck(const double*);
+
+	// places a puck at the given location with the given velocity
+	void launchPuck(const int, const Vec2&, const Vec2&);
+
+	// Spreads the pucks over the middle of the table in a grid, stopped
+	void rackPucks();
+
+	// Returns the physics state as of the last step (only safe from the thread stepping physics)
+	const WorldState& getState();
+
+	// Returns the constants this physics runs with
+	const PhysicsParameters& getParameters();
+
+	// Reports how many times pucks have bounced off a paddle
+	unsigned long getPaddleHitCount();
+
+	// Drives paddle two from the given CPU opponent instead of the sensor (NULL hands it back to the sensor)
+	void setOpponent(PaddleAI*);
+
+private:
+
+	// Copies the latest published paddles into the physics state, extrapolated to the given steady-clock time (secs)
+	void updatePaddles(const double);
+
+	// Moves a puck out of the given paddle in one step, sliding it along a wall if the paddle pins it there
+	void depenetratePuck(const int, const Vec2&);
+
+	// Advances a puck through a step, stopping at each wall or paddle contact to resolve it
+	void sweepPuck(const int, const double);
+
+	// Finds the earliest time a puck touches a wall, skipping the goal mouths, returns false if none within maxTime
+	bool sweepWalls(const int, const double, double&, int&);
+
+	// Finds the earliest time a puck touches a moving paddle, returns false if none within maxTime
+	bool sweepPaddle(const int, const Vec2&, const Vec2&, const double, double&);
+
+	// Bounces and separates touching pucks, pairs found by the grid broadphase
+	void resolvePuckContacts();
+
+	// table this physics runs (dimensions, paddle input and world output)
+	TableState* tableState;
+
+	// constants this physics runs with
+	PhysicsParameters parameters;
+
+	// running count of puck bounces off paddles
+	unsigned long paddleHitCount;
+
+	// CPU opponent playing paddle two (NULL when the sensor tracks it)
+	PaddleAI* opponent;
+
+	// puck and paddle state owned by the physics thread
+	WorldState state;
+
+	// puck that scored last, the one resetPuck() returns
+	int scoredPuck;
+
+	// grid broadphase over the pucks, cells one puck diameter wide
+	SpatialGrid puckGrid;
+
+	// candidate puck pairs found this step (capacity kept between steps)
+	std::vector<BodyPair> puckPairs;
+
+	// paddle positions at the start of the current step
+	Vec2 paddleOne_lastPosition;
+	Vec2 paddleTwo_lastPosition;
 };
\ No newline at end of file
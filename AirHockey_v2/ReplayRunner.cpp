@@ -0,0 +1,109 @@
+#include "ReplayRunner.h"
+
+// Constructor, replays the given sensor's recording into the given table's physics
+ReplayRunner::ReplayRunner(TableState* table, Sensor* replaySensor, Physics* replayPhysics) {
+
+	// remember table, sensor and physics
+	tableState = table;
+	sensor = replaySensor;
+	physics = replayPhysics;
+
+	// nothing replayed yet (FNV-1a offset basis)
+	trajectoryHash = 14695981039346656037ULL;
+	frames = 0;
+	steps = 0;
+}
+
+// Puts the puck in the middle and replays every recorded frame as fast as possible, returns false if the recording held no frames
+bool ReplayRunner::run() {
+
+	// fixed physics step, same as the live loop
+	const long double stepDuration_micros = 1e6L / (GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO);
+
+	// recorded time (secs) of the first frame
+	double startTime = 0;
+
+	// set puck to middle of table
+	physics->resetPuck(tableState->table_center);
+
+	// iterate through every recorded frame in order (single thread, so none are dropped)
+	while (sensor->collectFrameFromCamera()) {
+
+		// detect and filter paddles in the frame
+		if (!sensor->nextFrame())
+			continue;
+		sensor->processFrame();
+		sensor->updatePaddles();
+
+		// recorded capture time of this frame
+		double frameTime = sensor->getCaptureTime();
+
+		// first frame starts the simulation clock
+		if (frames++ == 0)
+			startTime = frameTime;
+
+		// step physics up to the frame's capture time (step times are multiples of the step, no drift)
+		while (startTime + (steps + 1) * static_cast<double>(stepDuration_micros * 1e-6L) <= frameTime) {
+
+			// advance simulation clock
+			steps++;
+
+			// tick physics, check if a goal has been scored (only in play, as in the live loop)
+			if (tableState->gameState == IN_PLAY) {
+				physics->tick(stepDuration_micros, startTime + steps * static_cast<double>(stepDuration_micros * 1e-6L));
+				physics->scoreGoals();
+			}
+
+			// no celebration screens without graphics, resume play immediately
+			tableState->gameState = IN_PLAY;
+
+			// fold published state into the hash
+			hashWorld();
+		}
+	}
+
+	// report whether anything was replayed
+	return frames > 0;
+}
+
+// Folds the published puck and paddle vectors into the trajectory hash
+void ReplayRunner::hashWorld() {
+
+	// read published state (the frame trace holds wall-clock times, so it's left out)
+	WorldState world = tableState->world_state.load();
+
+	// fold first puck and both paddles in
+	const Vec2 vectors[6] = { world.puck_positions[0], world.puck_velocities[0], world.paddleOne_position, world.paddleOne_velocity, world.paddleTwo_position, world.paddleTwo_velocity };
+	const unsigned char* bytes = reinterpret_cast<const unsigned char*>(vectors);
+	for (size_t i = 0; i < sizeof(vectors); i++)
+		trajectoryHash = (trajectoryHash ^ bytes[i]) * 1099511628211ULL;
+
+	// fold any further pucks in after them (multi-puck mode)
+	for (int p = 1; p < world.puck_count; p++) {
+		const Vec2 puckVectors[2] = { world.puck_positions[p], world.puck_velocities[p] };
+		bytes = reinterpret_cast<const unsigned char*>(puckVectors);
+		for (size_t i = 0; i < sizeof(puckVectors); i++)
+			trajectoryHash = (trajectoryHash ^ bytes[i]) * 1099511628211ULL;
+	}
+}
+
+// Reports the FNV-1a hash of every published puck and paddle state
+uint64_t ReplayRunner::getTrajectoryHash() {
+
+	// report running hash
+	return trajectoryHash;
+}
+
+// Reports the number of frames replayed
+unsigned long ReplayRunner::getFrameCount() {
+
+	// report count
+	return frames;
+}
+
+// Reports the number of physics steps taken
+unsigned long ReplayRunner::getStepCount() {
+
+	// report count
+	return steps;
+}
@@ -0,0 +1,40 @@
+#pragma once
+#include "GameData.h"
+#include "Physics.h"
+#include "Sensor.h"
+
+// Headless replay of a recorded session, physics steps on recorded time so runs of the same recording are bit-identical
+// Shared by the game's --replay mode and the regression tests, so both exercise the same stepping and hashing
+class ReplayRunner {
+public:
+
+	// Constructor, replays the given sensor's recording into the given table's physics
+	ReplayRunner(TableState*, Sensor*, Physics*);
+
+	// Puts the puck in the middle and replays every recorded frame as fast as possible, returns false if the recording held no frames
+	bool run();
+
+	// Reports the FNV-1a hash of every published puck and paddle state
+	uint64_t getTrajectoryHash();
+
+	// Reports the number of frames replayed and physics steps taken
+	unsigned long getFrameCount();
+	unsigned long getStepCount();
+
+private:
+
+	// Folds the published puck and paddle vectors into the trajectory hash
+	void hashWorld();
+
+	// table, replaying sensor and physics being driven
+	TableState* tableState;
+	Sensor* sensor;
+	Physics* physics;
+
+	// running hash of published states
+	uint64_t trajectoryHash;
+
+	// frames replayed and physics steps taken
+	unsigned long frames;
+	unsigned long steps;
+};
@@ -0,0 +1,27 @@
+#pragma once
+#include "LatencyHistogram.h"
+
+// Times its own lifetime and records it into a latency histogram when it goes out of scope
+// Header-only so the two clock reads inline into the timed loop
+class ScopedTimer {
+public:
+
+	// Constructor, starts timing
+	explicit ScopedTimer(LatencyHistogram& target) : histogram(target), start(std::chrono::steady_clock::now()) {
+	}
+
+	// Destructor, records elapsed time
+	~ScopedTimer() {
+
+		// measure lifetime and record it
+		histogram.record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count()));
+	}
+
+private:
+
+	// histogram receiving the sample
+	LatencyHistogram& histogram;
+
+	// time the timer was created
+	std::chrono::steady_clock::time_point start;
+};
@@ -2,165 +2,506 @@
 
 using namespace cv;
 
-// returns the distance between two 2D points
-double distance(cv::Point2d a, cv::Point2d b) {
+// Constructor, initializes the given table's IR sensor and flare detection, loading the camera's calibration if it has one
+Sensor::Sensor(TableState* table, const int port) : blobTracker(SENSOR_BRIGHTNESS_THRESHOLD, SENSOR_MIN_BLOB_AREA, SENSOR_MAX_BLOB_AREA, SENSOR_BLOB_DILATION, SENSOR_DOWNSAMPLE_RATIO) {
 
-	// report simple distance formula output
-	return sqrt(pow(a.x - b.x, 2) + pow(a.y - b.y, 2));
-}
-
-// Constructor, initializes IR sensor and flare detection
-Sensor::Sensor(const int port) {
+	// remember table this sensor calibrates and publishes paddles to
+	tableState = table;
 
 	// open port to IR sensor
 	sensor_ir = *(new VideoCapture(port));
 
-	// create empty image container
-	Mat setupImage;
+	// live camera, no replay, recording or synthetic source
+	replay = NULL;
+	recorder = NULL;
+	synthetic = NULL;
 
-	// fill with image from sensor buffer
+	// grab setup image from sensor buffer
+	Mat setupImage;
 	sensor_ir >> setupImage;
 
+	// size buffers and reset counters from setup image
+	initialize(setupImage);
+
+	// map detections through this camera's calibration if one was solved (--calibrate), otherwise scale the whole frame onto the table
+	loadCalibration(CALIBRATION_FILE_PREFIX + std::to_string(port) + ".bin");
+}
+
+// Constructor, replays a recording in place of the given table's IR sensor, mapping detections through the calibration it was made with
+Sensor::Sensor(TableState* table, const std::string& recordingPath) : blobTracker(SENSOR_BRIGHTNESS_THRESHOLD, SENSOR_MIN_BLOB_AREA, SENSOR_MAX_BLOB_AREA, SENSOR_BLOB_DILATION, SENSOR_DOWNSAMPLE_RATIO) {
+
+	// remember table this sensor calibrates and publishes paddles to
+	tableState = table;
+
+	// open recording instead of camera
+	replay = new FrameReplay(recordingPath);
+	recorder = NULL;
+	synthetic = NULL;
+
+	// build blank setup image in the recorded format
+	Mat setupImage(replay->getRows(), replay->getCols(), replay->getType());
+
+	// size buffers and reset counters from setup image
+	initialize(setupImage);
+
+	// map detections through the calibration the recording was made with, otherwise scale the whole frame onto the table
+	setCalibration(replay->getCalibration());
+}
+
+// Constructor, takes ownership of a synthetic frame source in place of the given table's IR sensor
+Sensor::Sensor(TableState* table, SyntheticFrameSource* source) : blobTracker(SENSOR_BRIGHTNESS_THRESHOLD, SENSOR_MIN_BLOB_AREA, SENSOR_MAX_BLOB_AREA, SENSOR_BLOB_DILATION, SENSOR_DOWNSAMPLE_RATIO) {
+
+	// remember table this sensor calibrates and publishes paddles to
+	tableState = table;
+
+	// use generated frames instead of camera
+	replay = NULL;
+	recorder = NULL;
+	synthetic = source;
+
+	// build blank setup image in the generated format
+	Mat setupImage(synthetic->getRows(), synthetic->getCols(), synthetic->getType());
+
+	// size buffers and reset counters from setup image
+	initialize(setupImage);
+}
+
+// Destructor, closes any recording, replay file or synthetic source
+Sensor::~Sensor() {
+
+	// release frame sources (NULL is safe to delete)
+	delete replay;
+	delete recorder;
+	delete synthetic;
+}
+
+// Sizes buffers and resets counters from a setup image
+void Sensor::initialize(const Mat& setupImage) {
+
 	// gather image dimensions for mapping calculations
 	sensorFrame_width = setupImage.cols;
 	sensorFrame_height = setupImage.rows;
 
-	// preconfigure and create flare detector
-	SimpleBlobDetector::Params sensorDetectionEngineParameters;
-	sensorDetectionEngineParameters.filterByArea = true;
-	sensorDetectionEngineParameters.filterByCircularity = false;
-	sensorDetectionEngineParameters.filterByColor = false;
-	sensorDetectionEngineParameters.filterByConvexity = false;
-	sensorDetectionEngineParameters.filterByInertia = false;
-	sensorDetectionEngineParameters.minArea = 100 / pow(SENSOR_DOWNSAMPLE_RATIO, 2);
-	sensorDetectionEngineParameters.maxArea = 10000 / pow(SENSOR_DOWNSAMPLE_RATIO, 2);
-	sensorDetectionEngine = SimpleBlobDetector::create(sensorDetectionEngineParameters);
+	// size every frame slot like the setup image
+	frameQueue.allocateSlots(setupImage);
+
+	// nothing processed yet, the first frame taken seeds the capture clock
+	currentFrame = NULL;
+	currentCaptureTime = std::chrono::steady_clock::time_point();
+	lastCaptureTime = currentCaptureTime;
+	takenTime = 0;
+
+	// no reallocations yet
+	frameAllocationCount = 0;
+	captureAllocationCount = 0;
+
+	// source running, no empty grabs yet
+	emptyGrabCount = 0;
+	sourceEnded = false;
+
+	// reserve room for detections so the point vectors don't grow per frame
+	detectedPoints.reserve(16);
+	detectedTablePoints.reserve(16);
+}
+
+// Starts writing every captured frame to a recording, returns false if already recording or the file can't be opened
+bool Sensor::startRecording(const std::string& recordingPath) {
+
+	// refuse to replace a recording in progress
+	if (recorder != NULL)
+		return false;
+
+	// open recording file, storing the calibration so replays map detections the same way
+	recorder = new FrameRecorder(recordingPath, calibration);
+
+	// check if recording can proceed, drop the recorder otherwise so a later attempt can retry
+	if (!recorder->isOpen()) {
+		delete recorder;
+		recorder = NULL;
+		return false;
+	}
+	return true;
+}
+
+// Reports whether frames come from a recording instead of the camera
+bool Sensor::isReplaying() {
+
+	// replay exists only in replay mode
+	return replay != NULL;
+}
+
+// Restarts a replay from its first frame, returns false if not replaying
+bool Sensor::rewindReplay() {
+
+	// check if replaying, seek recording back to its start
+	return replay != NULL && replay->rewind();
+}
+
+// Reads a camera calibration for this sensor's frame size, returns false (keeping the current one) if it can't be used
+bool Sensor::loadCalibration(const std::string& path) {
+
+	// read into a scratch fit so a bad file leaves the current one in place
+	CameraCalibration loaded;
+	if (!loaded.load(path, static_cast<int>(sensorFrame_width), static_cast<int>(sensorFrame_height)))
+		return false;
+
+	// adopt fit
+	calibration = loaded;
+	return true;
+}
+
+// Replaces the camera calibration mapping detections onto the projection
+void Sensor::setCalibration(const CameraCalibration& fitted) {
+
+	// adopt fit
+	calibration = fitted;
+}
+
+// Reports the sensor's frame width
+int Sensor::getFrameWidth() {
+
+	// report setup image width
+	return static_cast<int>(sensorFrame_width);
+}
+
+// Reports the sensor's frame height
+int Sensor::getFrameHeight() {
+
+	// report setup image height
+	return static_cast<int>(sensorFrame_height);
+}
+
+// Changes the flare detector's pixel stride (SENSOR_DOWNSAMPLE_RATIO by default)
+void Sensor::setDownsampleRatio(const int ratio) {
+
+	// pass stride to detector
+	blobTracker.setStride(ratio);
 }
 
 // Uses uS sensor to predict physical projection size
 void Sensor::detectProjectionSize() {
 
-	// TODO
-	double projectorDistance = 1000;// TODO: use the uS sensor here
+	// TODO: use the uS sensor here
+	double projectorDistance = PROJECTOR_DEFAULT_DISTANCE;
 
-	// calculate table dimensions from spread and distance
-	table_width = projectorDistance * PROJECTOR_SPREAD_HORIZ;
-	table_height = projectorDistance * PROJECTOR_SPREAD_VERT;
-
-	// calculate important table points
-	table_center[0] = table_width / 2;
-	table_center[1] = table_height / 2;
-	table_centerLeft[0] = table_width / 4;
-	table_centerLeft[1] = table_center[1];
-	table_centerRight[0] = table_width * 3 / 4;
-	table_centerRight[1] = table_center[1];
+	// size table and its important points from the distance
+	tableState->setDimensions(projectorDistance);
 
 	// calculate sensor -> table conversion factors
-	widthRatio_sensorToTable = table_width / sensorFrame_width;
-	heightRatio_sensorToTable = table_height / sensorFrame_height;
+	widthRatio_sensorToTable = tableState->table_width / sensorFrame_width;
+	heightRatio_sensorToTable = tableState->table_height / sensorFrame_height;
+
+	// calculate projected image -> table conversion factors (the calibration maps sensor space onto the projected image)
+	widthRatio_projectionToTable = tableState->table_width / OUTPUT_IMAGE_WIDTH;
+	heightRatio_projectionToTable = tableState->table_height / OUTPUT_IMAGE_HEIGHT;
+
+	// clear paddle velocities and default paddle positions approximately where real-world paddles should be
+	paddles = PaddleState();
+	paddles.paddleOne_position.x = tableState->table_centerLeft[0];
+	paddles.paddleOne_position.y = tableState->table_centerLeft[1];
+	paddles.paddleTwo_position.x = tableState->table_centerRight[0];
+	paddles.paddleTwo_position.y = tableState->table_centerRight[1];
+
+	// start filters at the default positions, untracked
+	paddleOne_filter.reset(paddles.paddleOne_position);
+	paddleTwo_filter.reset(paddles.paddleTwo_position);
+
+	// make default paddle state visible to other threads
+	tableState->paddle_state.store(paddles);
+}
+
+// Pulls an image from camera buffer (or recording) into the frame queue, returns false if none was published (empty grab or ended source)
+bool Sensor::collectFrameFromCamera() {
+
+	// check if the source already ended
+	if (sourceEnded)
+		return false;
+
+	// get slot owned by capture, remember its address so a reallocation can be detected
+	Mat& slot = frameQueue.writeSlot();
+	const uchar* frameData = slot.data;
+
+	// time at which the frame was captured
+	std::chrono::steady_clock::time_point captureTime;
+
+	// check if replaying, read next recorded frame and its original capture time
+	if (replay != NULL) {
+		if (!replay->readFrame(slot, captureTime)) {
+			sourceEnded = true;
+			return false;
+		}
+	}
+
+	// check if generating, wait for and draw the next synthetic frame (already stamped with its capture time)
+	else if (synthetic != NULL)
+		synthetic->readFrame(slot, captureTime);
+	else {
+
+		// streams cam buffer to slot (reuses memory while frame size is unchanged)
+		sensor_ir >> slot;
+
+		// stamp frame as soon as the grab returns
+		captureTime = std::chrono::steady_clock::now();
+	}
+
+	// check if slot had to be reallocated
+	if (slot.data != frameData)
+		captureAllocationCount++;
+
+	// drop empty grabs, backing off so an unplugged camera doesn't spin capture, and give up on one that stays empty
+	if (slot.empty()) {
+		sourceEnded = (++emptyGrabCount >= SENSOR_MAX_EMPTY_GRABS);
+		if (!sourceEnded)
+			std::this_thread::sleep_for(std::chrono::milliseconds(SENSOR_EMPTY_GRAB_BACKOFF_MS));
+		return false;
+	}
+
+	// camera delivering again
+	emptyGrabCount = 0;
+
+	// check if recording, save frame before processing can take it
+	if (recorder != NULL)
+		recorder->writeFrame(slot, captureTime);
+
+	// hand frame to processing
+	frameQueue.publish(captureTime);
+
+	// report frame published
+	return true;
 }
 
-// Pulls an image from camera buffer into memory buffer
-void Sensor::collectFrameFromCamera() {
+// Reports whether the frame source has ended (recording finished or camera lost)
+bool Sensor::hasSourceEnded() {
 
-	// streams cam buffer to mem buffer
-	sensor_ir >> bufferImage;
+	// report capture state
+	return sourceEnded;
 }
 
 
-// Preprocesses image and detects flares
+// Takes the newest captured frame, waiting up to the given time (ms), returns false if no new frame arrived
+bool Sensor::nextFrame(const int wait_ms) {
+
+	// check if this is the first frame (there is no previous capture to measure from)
+	bool firstFrame = (currentFrame == NULL);
+
+	// wait for the newest frame, older untaken frames are dropped by the queue
+	std::chrono::steady_clock::time_point captureTime;
+	if (!frameQueue.takeLatest(currentFrame, captureTime, wait_ms))
+		return false;
+
+	// shift capture times for velocity calculations, the first frame only seeds them (never the host clock, replays must not depend on it)
+	lastCaptureTime = firstFrame ? captureTime : currentCaptureTime;
+	currentCaptureTime = captureTime;
+
+	// note when processing took the frame
+	takenTime = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+
+	// report new frame taken
+	return true;
+}
+
+// Detects flares in the current frame
 void Sensor::processFrame() {
 
-	// create empty image containers for intermediate steps
-	Mat alphaImage, dilatedAlphaImage, imageForDetector;
+	// check if a frame has been taken yet
+	if (currentFrame == NULL)
+		return;
 
-	// fill container with binary image to filer low brightness false positives
-	inRange(bufferImage, Scalar(0, 0, 0), Scalar(240, 240, 240), alphaImage);
+	// alias current frame for detection
+	const Mat& frame = *currentFrame;
 
-	// fill container with dilated version of alpha image to close gaps
-	dilate(alphaImage, dilatedAlphaImage, 0, Point(-1, -1), 5);
+	// remember point capacity and tracker growth so reallocations can be detected
+	size_t pointCapacity = detectedPoints.capacity();
+	unsigned long trackerAllocations = blobTracker.getAllocationCount();
 
-	// check if downsampling ratio is remarkable (not 1)
-	if (SENSOR_DOWNSAMPLE_RATIO > 1)
+	// forget last frame's flares
+	detectedPoints.clear();
 
-		// downsample image to reduce flare detection time
-		resize(dilatedAlphaImage, imageForDetector, Size(sensorFrame_width / SENSOR_DOWNSAMPLE_RATIO, sensorFrame_height / SENSOR_DOWNSAMPLE_RATIO));
-	else
-		
-		// move entire image to detector
-		imageForDetector = dilatedAlphaImage;
+	// search windows around where the paddles were last seen
+	Rect windowOne = searchWindow(paddles.paddleOne_position);
+	Rect windowTwo = searchWindow(paddles.paddleTwo_position);
+
+	// flag for a paddle missing from its window
+	bool paddleLost;
+
+	// check if windows overlap, search their union once so no flare is counted twice
+	if ((windowOne & windowTwo).area() > 0)
+		paddleLost = blobTracker.detect(frame, windowOne | windowTwo, detectedPoints) < 2;
+	else {
+
+		// search each window separately
+		int foundOne = blobTracker.detect(frame, windowOne, detectedPoints);
+		int foundTwo = blobTracker.detect(frame, windowTwo, detectedPoints);
+		paddleLost = (foundOne == 0 || foundTwo == 0);
+	}
 
-	// run flare detection and record points
-	sensorDetectionEngine->detect(imageForDetector, detectedPoints);
+	// check if a paddle was lost, fall back to searching the entire frame
+	if (paddleLost) {
+		detectedPoints.clear();
+		blobTracker.detect(frame, Rect(0, 0, frame.cols, frame.rows), detectedPoints);
+	}
+
+	// check if any buffer had to be reallocated this frame
+	if (detectedPoints.capacity() != pointCapacity || blobTracker.getAllocationCount() != trackerAllocations)
+		frameAllocationCount++;
 }
 
-// Locates paddles and calculates live velocities
-void Sensor::updatePaddles(const double deltaTime_micros) {
+// Calculates the sensor-space search window around a table-space paddle position
+Rect Sensor::searchWindow(const Vec2& paddle_position) {
+
+	// convert paddle position from table space to sensor space, through the calibration if there is one
+	int centerX, centerY;
+	if (calibration.isCalibrated()) {
+		Point2f center = calibration.toSensor(Vec2(paddle_position.x / widthRatio_projectionToTable, paddle_position.y / heightRatio_projectionToTable));
+		centerX = static_cast<int>(center.x);
+		centerY = static_cast<int>(center.y);
+	}
+	else {
+		centerX = static_cast<int>(paddle_position.x / widthRatio_sensorToTable);
+		centerY = static_cast<int>(paddle_position.y / heightRatio_sensorToTable);
+	}
+
+	// build square window around paddle
+	return Rect(centerX - SENSOR_TRACKING_WINDOW / 2, centerY - SENSOR_TRACKING_WINDOW / 2, SENSOR_TRACKING_WINDOW, SENSOR_TRACKING_WINDOW);
+}
 
-	// save former positions for velocity calculations
-	double paddleOne_lastPosition[2] = { paddleOne_position[0], paddleOne_position[1] };
-	double paddleTwo_lastPosition[2] = { paddleTwo_position[0], paddleTwo_position[1] };
+// Locates paddles and filters their positions and velocities
+void Sensor::updatePaddles() {
 
-	// check if downsample ratio was remarkable (not 1)
-	if (SENSOR_DOWNSAMPLE_RATIO > 1)
+	// time between the captures of the previous and current frames (not processing time)
+	double deltaTime_secs = std::chrono::duration<double>(currentCaptureTime - lastCaptureTime).count();
 
-		// iterate through detected points
-		for (int i = 0; i < detectedPoints.size(); i++) {
+	// skip update if capture times can't give a rate
+	if (deltaTime_secs <= 0)
+		return;
 
-			// transpose detected points to table space
-			detectedPoints.at(i).pt.x *= SENSOR_DOWNSAMPLE_RATIO;
-			detectedPoints.at(i).pt.y *= SENSOR_DOWNSAMPLE_RATIO;
-		}
+	// convert each detection to table space once, association and filtering both work there
+	detectedTablePoints.clear();
+	for (size_t i = 0; i < detectedPoints.size(); i++)
+		detectedTablePoints.push_back(toTable(detectedPoints[i].pt));
+
+	// find detections nearest where each paddle is expected on its half of the table
+	int indexOne = nearestPoint(paddleOne_filter.predict(deltaTime_secs), true);
+	int indexTwo = nearestPoint(paddleTwo_filter.predict(deltaTime_secs), false);
+
+	// correct paddle one with its detection, or coast if it wasn't seen
+	if (indexOne != -1)
+		paddleOne_filter.update(detectedTablePoints[indexOne], deltaTime_secs);
+	else
+		paddleOne_filter.coast(deltaTime_secs);
+
+	// correct paddle two with its detection, or coast if it wasn't seen
+	if (indexTwo != -1)
+		paddleTwo_filter.update(detectedTablePoints[indexTwo], deltaTime_secs);
+	else
+		paddleTwo_filter.coast(deltaTime_secs);
+
+	// copy filtered estimates into paddle snapshot
+	paddles.paddleOne_position = paddleOne_filter.getPosition();
+	paddles.paddleOne_velocity = paddleOne_filter.getVelocity();
+	paddles.paddleOne_confidence = paddleOne_filter.getConfidence();
+	paddles.paddleTwo_position = paddleTwo_filter.getPosition();
+	paddles.paddleTwo_velocity = paddleTwo_filter.getVelocity();
+	paddles.paddleTwo_confidence = paddleTwo_filter.getConfidence();
+
+	// stamp snapshot with its frame's trace so physics can extrapolate it and latency can be accounted
+	paddles.trace.captured = getCaptureTime();
+	paddles.trace.taken = takenTime;
+	paddles.trace.published = std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+	paddles.trace.stepped = 0;
+
+	// publish complete paddle snapshot to physics
+	tableState->paddle_state.store(paddles);
+}
+
+// Finds the table-space detection nearest a table-space position on one half of the table, returns -1 if none
+int Sensor::nearestPoint(const Vec2& expected, const bool leftHalf) {
 
 	// initialize index and value for shortest distance
 	int index = -1;
-	double min_dist = 1e10;
+	double min_dist = 1e20;
+
+	// iterate through detected points (already in table space)
+	for (int i = 0; i < static_cast<int>(detectedTablePoints.size()); i++) {
 
-	// iterate through detected points
-	for (int i = 0; i < detectedPoints.size(); i++)
+		// alias point
+		const Vec2& point = detectedTablePoints[i];
+
+		// skip points on the other paddle's half
+		if ((point.x < tableState->table_width / 2) != leftHalf)
+			continue;
 
 		// check if distance is shorter than current shortest
-		if (distance(detectedPoints.at(i).pt, Point2d(paddleOne_lastPosition[0], paddleOne_lastPosition[1])) < min_dist && detectedPoints.at(i).pt.x < (sensorFrame_width / 2)) {
-			
+		double dist = (point - expected).lengthSquared();
+		if (dist < min_dist) {
+
 			// record as new current shortest distance
 			index = i;
-			min_dist = distance(detectedPoints.at(i).pt, Point2d(paddleOne_lastPosition[0], paddleOne_lastPosition[1]));
+			min_dist = dist;
 		}
+	}
+
+	// report nearest point, if any
+	return index;
+}
 
-	// check if a viable point was found
-	if (index != -1) {
+// Converts a sensor-space point to table space
+Vec2 Sensor::toTable(const Point2f& point) {
 
-		// set paddle one position to new location
-		paddleOne_position[0] = detectedPoints.at(index).pt.x * widthRatio_sensorToTable;
-		paddleOne_position[1] = detectedPoints.at(index).pt.y * heightRatio_sensorToTable;
+	// check if calibrated, undistort and map onto the projected image, then scale to the table
+	if (calibration.isCalibrated()) {
+		Vec2 projected = calibration.toProjection(point);
+		return Vec2(projected.x * widthRatio_projectionToTable, projected.y * heightRatio_projectionToTable);
 	}
 
-	// initialize index and value for shortest distance
-	index = -1;
-	min_dist = 1e10;
+	// otherwise scale by sensor -> table ratios
+	return Vec2(point.x * widthRatio_sensorToTable, point.y * heightRatio_sensorToTable);
+}
 
-	// iterate through detected points
-	for (int i = 0; i < detectedPoints.size(); i++)
+// Searches the whole current frame for a single projected calibration marker, returns false unless exactly one is seen
+bool Sensor::detectMarker(Point2f& marker) {
 
-		// check if distance is shorter than current shortest
-		if (distance(detectedPoints.at(i).pt, Point2d(paddleTwo_lastPosition[0], paddleTwo_lastPosition[1])) < min_dist && detectedPoints.at(i).pt.x > (sensorFrame_width / 2)) {
-			
-			// record as new current shortest distance
-			index = i;
-			min_dist = distance(detectedPoints.at(i).pt, Point2d(paddleTwo_lastPosition[0], paddleTwo_lastPosition[1]));
-		}
+	// check if a frame has been taken yet
+	if (currentFrame == NULL)
+		return false;
 
-	// check if a viable point was found
-	if (index != -1) {
+	// search entire frame
+	detectedPoints.clear();
+	blobTracker.detect(*currentFrame, Rect(0, 0, currentFrame->cols, currentFrame->rows), detectedPoints);
 
-		// set paddle two position to new location
-		paddleTwo_position[0] = detectedPoints.at(index).pt.x * widthRatio_sensorToTable;
-		paddleTwo_position[1] = detectedPoints.at(index).pt.y * heightRatio_sensorToTable;
-	}
+	// check marker is unambiguous (a stray flare or reflection would pair with the wrong grid point)
+	if (detectedPoints.size() != 1)
+		return false;
+
+	// report marker center
+	marker = detectedPoints[0].pt;
+	return true;
+}
+
+// Reports how many frames had to grow a frame slot, point vector or detector buffer since construction (a buffer-reuse check, allocations inside OpenCV calls aren't seen)
+unsigned long Sensor::getFrameAllocationCount() {
+
+	// report running total across capture and processing
+	return frameAllocationCount + captureAllocationCount.load();
+}
+
+// Reports how many captured frames were dropped for a newer one before processing
+unsigned long Sensor::getDroppedFrameCount() {
+
+	// report queue total
+	return frameQueue.getDroppedCount();
+}
+
+// Reports how many captured frames were processed
+unsigned long Sensor::getProcessedFrameCount() {
+
+	// report queue total
+	return frameQueue.getProcessedCount();
+}
+
+// Reports the steady-clock capture time (secs) of the last processed frame
+double Sensor::getCaptureTime() {
 
-	// use previous and current positions to calculate near-instantaneous velocity
-	paddleOne_velocity[0] = (paddleOne_position[0] - paddleOne_lastPosition[0]) / (deltaTime_micros / 1e6);
-	paddleOne_velocity[1] = (paddleOne_position[1] - paddleOne_lastPosition[1]) / (deltaTime_micros / 1e6);
-	paddleTwo_velocity[0] = (paddleTwo_position[0] - paddleTwo_lastPosition[0]) / (deltaTime_micros / 1e6);
-	paddleTwo_velocity[1] = (paddleTwo_position[1] - paddleTwo_lastPosition[1]) / (deltaTime_micros / 1e6);
+	// convert capture time to seconds
+	return std::chrono::duration<double>(currentCaptureTime.time_since_epoch()).count();
 }
\ No newline at end of file
@@ -1,43 +1,159 @@
 #pragma once
 #include "GameData.h"
+#include "BlobTracker.h"
+#include "CameraCalibration.h"
+#include "FrameQueue.h"
+#include "PaddleFilter.h"
+#include "FrameRecorder.h"
+#include "FrameReplay.h"
+#include "SyntheticFrameSource.h"
 
 // Sensor handling class, controls IR sensor and data extraction
 class Sensor {
 public:
 
-	// Constructor, initializes IR sensor and flare detection
-	Sensor(const int);
+	// Constructor, initializes the given table's IR sensor and flare detection, loading the camera's calibration if it has one
+	Sensor(TableState*, const int);
+
+	// Constructor, replays a recording in place of the given table's IR sensor, mapping detections through the calibration it was made with
+	Sensor(TableState*, const std::string&);
+
+	// Constructor, takes ownership of a synthetic frame source in place of the given table's IR sensor
+	Sensor(TableState*, SyntheticFrameSource*);
+
+	// Destructor, closes any recording, replay file or synthetic source
+	~Sensor();
+
+	// Starts writing every captured frame to a recording, returns false if already recording or the file can't be opened
+	bool startRecording(const std::string&);
+
+	// Reports whether frames come from a recording instead of the camera
+	bool isReplaying();
+
+	// Restarts a replay from its first frame, returns false if not replaying
+	bool rewindReplay();
+
+	// Reads a camera calibration for this sensor's frame size, returns false (keeping the current one) if it can't be used
+	bool loadCalibration(const std::string&);
+
+	// Replaces the camera calibration mapping detections onto the projection
+	void setCalibration(const CameraCalibration&);
+
+	// Reports the sensor's frame width and height
+	int getFrameWidth();
+	int getFrameHeight();
+
+	// Changes the flare detector's pixel stride (SENSOR_DOWNSAMPLE_RATIO by default)
+	void setDownsampleRatio(const int);
 
 	// Uses uS sensor to predict physical projection size
 	void detectProjectionSize();
 
-	// Pulls an image from camera buffer into memory buffer
-	void collectFrameFromCamera();
+	// Pulls an image from camera buffer (or recording) into the frame queue, returns false if none was published (empty grab or ended source)
+	bool collectFrameFromCamera();
+
+	// Reports whether the frame source has ended (recording finished or camera lost)
+	bool hasSourceEnded();
 
-	// Preprocesses image and detects flares
+	// Takes the newest captured frame, waiting up to the given time (ms), returns false if no new frame arrived
+	bool nextFrame(const int = SENSOR_FRAME_WAIT_MS);
+
+	// Detects flares in the current frame
 	void processFrame();
 
-	// Locates paddles and calculates live velocities
-	void updatePaddles(const double);
+	// Locates paddles and filters their positions and velocities
+	void updatePaddles();
+
+	// Searches the whole current frame for a single projected calibration marker, returns false unless exactly one is seen
+	bool detectMarker(cv::Point2f&);
+
+	// Reports how many frames had to grow a frame slot, point vector or detector buffer since construction (a buffer-reuse check, allocations inside OpenCV calls aren't seen)
+	unsigned long getFrameAllocationCount();
+
+	// Reports how many captured frames were dropped for a newer one before processing
+	unsigned long getDroppedFrameCount();
+
+	// Reports how many captured frames were processed
+	unsigned long getProcessedFrameCount();
+
+	// Reports the steady-clock capture time (secs) of the last processed frame
+	double getCaptureTime();
 private:
 
-	// conversion ratios for sensor-space to table-space
+	// Sizes buffers and resets counters from a setup image
+	void initialize(const cv::Mat&);
+
+	// Calculates the sensor-space search window around a table-space paddle position
+	cv::Rect searchWindow(const Vec2&);
+
+	// Finds the table-space detection nearest a table-space position on one half of the table, returns -1 if none
+	int nearestPoint(const Vec2&, const bool);
+
+	// Converts a sensor-space point to table space
+	Vec2 toTable(const cv::Point2f&);
+
+	// table this sensor calibrates and publishes paddles to
+	TableState* tableState;
+
+	// conversion ratios for sensor-space to table-space, used until the camera is calibrated
 	double widthRatio_sensorToTable;
 	double heightRatio_sensorToTable;
 
+	// conversion ratios for projected image space to table-space
+	double widthRatio_projectionToTable;
+	double heightRatio_projectionToTable;
+
+	// lens and homography mapping sensor-space onto the projected image (applied per detection, never per pixel)
+	CameraCalibration calibration;
+
 	// input image frame dimensions
 	double sensorFrame_width;
 	double sensorFrame_height;
 
-	// flare detection candidate point vector
+	// tracked paddle positions and velocities, owned by the sensor thread
+	PaddleState paddles;
+
+	// per-paddle tracking filters
+	PaddleFilter paddleOne_filter;
+	PaddleFilter paddleTwo_filter;
+
+	// flare detection candidate point vector, and the same points converted to table space
 	std::vector<cv::KeyPoint> detectedPoints;
+	std::vector<Vec2> detectedTablePoints;
 
-	// memory space to store current frame
-	cv::Mat bufferImage;
+	// captured frames waiting for processing
+	FrameQueue frameQueue;
 
-	// flare detector reference (uninitialied)
-	cv::Ptr<cv::SimpleBlobDetector> sensorDetectionEngine;
+	// frame being processed (owned by the queue) and when it and the previous frame were captured
+	const cv::Mat* currentFrame;
+	std::chrono::steady_clock::time_point currentCaptureTime;
+	std::chrono::steady_clock::time_point lastCaptureTime;
+
+	// steady-clock time (secs) the current frame was taken from the queue
+	double takenTime;
+
+	// consecutive empty camera grabs, and whether the source has ended, tracked by the capture thread
+	int emptyGrabCount;
+	bool sourceEnded;
+
+	// number of camera frames that reallocated their slot, counted by the capture thread
+	std::atomic<unsigned long> captureAllocationCount;
+
+	// number of frames that grew a point vector or detector buffer, stays flat in steady state
+	unsigned long frameAllocationCount;
+
+	// flare detector
+	BlobTracker blobTracker;
 
 	// sensor reference (uninitialized)
 	cv::VideoCapture sensor_ir;
+
+	// recorded frame source (NULL when using the camera)
+	FrameReplay* replay;
+
+	// recording of captured frames (NULL when not recording)
+	FrameRecorder* recorder;
+
+	// generated frame source for latency tests (NULL otherwise)
+	SyntheticFrameSource* synthetic;
 };
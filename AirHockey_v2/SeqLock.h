@@ -0,0 +1,76 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <type_traits>
+
+// Single-writer sequence lock, publishes whole snapshots of a trivially copyable type
+// Readers never block the writer, they retry if a write overlapped their copy
+template <typename T>
+class SeqLock {
+public:
+
+	// Constructor, publishes a value-initialized snapshot
+	SeqLock() : sequence(0) {
+
+		// store default snapshot so early readers see zeros
+		store(T());
+	}
+
+	// Publishes a complete snapshot (only one thread may call this)
+	void store(const T& value) {
+
+		// stage value in word-sized chunks
+		uint64_t buffer[N_WORDS] = {};
+		memcpy(buffer, &value, sizeof(T));
+
+		// mark write as in progress (odd sequence)
+		unsigned int seq = sequence.load(std::memory_order_relaxed);
+		sequence.store(seq + 1, std::memory_order_relaxed);
+
+		// copy snapshot into shared storage (release keeps the odd mark ahead of the data)
+		for (size_t i = 0; i < N_WORDS; i++)
+			words[i].store(buffer[i], std::memory_order_release);
+
+		// mark write as complete (even sequence)
+		sequence.store(seq + 2, std::memory_order_release);
+	}
+
+	// Retrieves the most recently published complete snapshot
+	T load() const {
+
+		// staging area for the copied words
+		uint64_t buffer[N_WORDS];
+		unsigned int seqBefore, seqAfter;
+
+		// copy until the sequence shows no write overlapped the copy
+		do {
+			seqBefore = sequence.load(std::memory_order_acquire);
+
+			// acquire keeps the second sequence read behind the data
+			for (size_t i = 0; i < N_WORDS; i++)
+				buffer[i] = words[i].load(std::memory_order_acquire);
+
+			seqAfter = sequence.load(std::memory_order_relaxed);
+		} while (seqBefore != seqAfter || (seqBefore & 1));
+
+		// unpack words into snapshot
+		T value;
+		memcpy(&value, buffer, sizeof(T));
+		return value;
+	}
+
+private:
+
+	// snapshots are copied as raw bytes, so they must be plain data
+	static_assert(std::is_trivially_copyable<T>::value, "SeqLock requires a trivially copyable type");
+
+	// number of 64-bit words needed to hold one snapshot
+	static const size_t N_WORDS = (sizeof(T) + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+
+	// write counter, odd while a write is in progress
+	std::atomic<unsigned int> sequence;
+
+	// snapshot storage, atomic words so concurrent copies are well-defined
+	std::atomic<uint64_t> words[N_WORDS];
+};
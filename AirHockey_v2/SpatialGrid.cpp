@@ -0,0 +1,113 @@
+#include "SpatialGrid.h"
+
+using namespace std;
+
+// Constructor, empty grid (resize before building)
+SpatialGrid::SpatialGrid() {
+
+	// one cell until sized
+	cellSize = 1;
+	columns = 1;
+	rows = 1;
+	cellStart.assign(2, 0);
+
+	// nothing built yet
+	bodyCount = 0;
+}
+
+// Covers a width x height area with square cells of the given side (at least the contact distance)
+void SpatialGrid::resize(const double width, const double height, const double side) {
+
+	// store cell side, at least one cell each way
+	cellSize = (side > 0) ? side : 1;
+	columns = max(1, static_cast<int>(ceil(width / cellSize)));
+	rows = max(1, static_cast<int>(ceil(height / cellSize)));
+
+	// size cell table (only allocates here)
+	cellStart.assign(columns * rows + 1, 0);
+}
+
+// Bins bodies into cells by position, bodies off the grid go to the nearest edge cell
+void SpatialGrid::build(const Vec2* positions, const int count) {
+
+	// make room for bodies (only grows)
+	bodyCount = count;
+	if (static_cast<int>(bodyCell.size()) < count) {
+		bodyCell.resize(count);
+		cellBodies.resize(count);
+	}
+
+	// count bodies per cell (cellStart[c + 1] holds cell c's count)
+	fill(cellStart.begin(), cellStart.end(), 0);
+	for (int i = 0; i < count; i++) {
+		bodyCell[i] = cellOf(positions[i]);
+		cellStart[bodyCell[i] + 1]++;
+	}
+
+	// turn counts into each cell's first slot
+	for (size_t c = 1; c < cellStart.size(); c++)
+		cellStart[c] += cellStart[c - 1];
+
+	// place bodies into their cells' slots, in index order
+	for (int i = 0; i < count; i++)
+		cellBodies[cellStart[bodyCell[i]]++] = i;
+
+	// placing advanced every start to the next cell's start, shift back
+	for (size_t c = cellStart.size() - 1; c > 0; c--)
+		cellStart[c] = cellStart[c - 1];
+	cellStart[0] = 0;
+}
+
+// Replaces pairs with every pair of built bodies sharing or bordering a cell (each once), returns number found
+int SpatialGrid::findPairs(std::vector<BodyPair>& pairs) {
+
+	// neighbouring cells checked from each cell (half of the 8, so each bordering pair of cells is visited once)
+	static const int neighbours[4][2] = { { 1, 0 }, { -1, 1 }, { 0, 1 }, { 1, 1 } };
+
+	// start a new list (keeps capacity)
+	pairs.clear();
+
+	// iterate through occupied cells
+	for (int row = 0; row < rows; row++) {
+		for (int column = 0; column < columns; column++) {
+			int cell = row * columns + column;
+			int start = cellStart[cell];
+			int end = cellStart[cell + 1];
+			if (start == end)
+				continue;
+
+			// pair bodies within the cell
+			for (int a = start; a < end; a++)
+				for (int b = a + 1; b < end; b++)
+					pairs.push_back({ cellBodies[a], cellBodies[b] });
+
+			// pair bodies with those in the neighbouring cells
+			for (int n = 0; n < 4; n++) {
+				int neighbourColumn = column + neighbours[n][0];
+				int neighbourRow = row + neighbours[n][1];
+				if (neighbourColumn < 0 || neighbourColumn >= columns || neighbourRow >= rows)
+					continue;
+				int neighbour = neighbourRow * columns + neighbourColumn;
+
+				// iterate through both cells' bodies, lower index first
+				for (int a = start; a < end; a++)
+					for (int b = cellStart[neighbour]; b < cellStart[neighbour + 1]; b++)
+						pairs.push_back({ min(cellBodies[a], cellBodies[b]), max(cellBodies[a], cellBodies[b]) });
+			}
+		}
+	}
+
+	// report number of candidate pairs
+	return static_cast<int>(pairs.size());
+}
+
+// Finds the cell holding a position, clamped to the grid
+int SpatialGrid::cellOf(const Vec2& position) {
+
+	// calculate cell coordinates, clamping (before converting, so far-off bodies can't overflow) keeps nearby bodies in the same or bordering cells
+	int column = static_cast<int>(min(max(floor(position.x / cellSize), 0.0), static_cast<double>(columns - 1)));
+	int row = static_cast<int>(min(max(floor(position.y / cellSize), 0.0), static_cast<double>(rows - 1)));
+
+	// report cell index
+	return row * columns + column;
+}
@@ -0,0 +1,48 @@
+#pragma once
+#include "GameData.h"
+#include <vector>
+
+// Two bodies close enough that they may touch (indices, first is lower)
+struct BodyPair {
+	int first;
+	int second;
+};
+
+// Uniform grid broadphase, bins bodies into square cells so only bodies in neighbouring cells are paired
+class SpatialGrid {
+public:
+
+	// Constructor, empty grid (resize before building)
+	SpatialGrid();
+
+	// Covers a width x height area with square cells of the given side (at least the contact distance)
+	void resize(const double, const double, const double);
+
+	// Bins bodies into cells by position, bodies off the grid go to the nearest edge cell
+	void build(const Vec2*, const int);
+
+	// Replaces pairs with every pair of built bodies sharing or bordering a cell (each once), returns number found
+	int findPairs(std::vector<BodyPair>&);
+
+private:
+
+	// Finds the cell holding a position, clamped to the grid
+	int cellOf(const Vec2&);
+
+	// cell side length and grid size in cells
+	double cellSize;
+	int columns;
+	int rows;
+
+	// first entry in cellBodies for each cell, one extra entry ends the last cell
+	std::vector<int> cellStart;
+
+	// body indices sorted by cell (counting sort, so bodies keep index order within a cell)
+	std::vector<int> cellBodies;
+
+	// cell of each built body
+	std::vector<int> bodyCell;
+
+	// number of built bodies
+	int bodyCount;
+};
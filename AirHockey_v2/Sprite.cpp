@@ -0,0 +1,117 @@
+#include "Sprite.h"
+
+using namespace cv;
+
+// Constructor, empty sprite (blits nothing)
+Sprite::Sprite() {
+
+	// no image, no advance
+	anchor = Point(0, 0);
+	advance = 0;
+}
+
+// Renders a circle of a radius (pixels), filled if thickness is negative, anchored at its center
+void Sprite::renderCircle(const double radius, const Scalar& circleColor, const int thickness) {
+
+	// half extent covering radius, half the stroke and an anti-aliasing fringe
+	int extent = static_cast<int>(ceil(radius + std::max(thickness, 0) / 2.0)) + 2;
+
+	// rasterize coverage once, anti-aliased, at sub-pixel precision about the center
+	Mat coverage = Mat::zeros(2 * extent + 1, 2 * extent + 1, CV_8UC1);
+	circle(coverage, Point(extent << 4, extent << 4), static_cast<int>(radius * 16 + 0.5), Scalar(255), thickness, LINE_AA, 4);
+
+	// anchor at center, circles don't advance
+	anchor = Point(extent, extent);
+	advance = 0;
+
+	// build blend planes from coverage
+	premultiply(coverage, circleColor);
+}
+
+// Renders text in a Hershey font at a scale and thickness, anchored at its baseline origin like putText
+void Sprite::renderText(const std::string& text, const int fontFace, const double scale, const Scalar& textColor, const int thickness) {
+
+	// measure text
+	int baseline = 0;
+	Size textSize = getTextSize(text, fontFace, scale, thickness, &baseline);
+
+	// pad for stroke thickness and anti-aliasing fringe
+	int padding = thickness + 2;
+
+	// rasterize coverage once, anti-aliased
+	Mat coverage = Mat::zeros(textSize.height + baseline + 2 * padding, textSize.width + 2 * padding, CV_8UC1);
+	anchor = Point(padding, padding + textSize.height);
+	putText(coverage, text, anchor, fontFace, scale, Scalar(255), thickness, LINE_AA);
+
+	// next glyph starts where putText would have placed it (measured width counts the stroke once per call)
+	advance = textSize.width - thickness;
+
+	// build blend planes from coverage
+	premultiply(coverage, textColor);
+}
+
+// Converts a rendered coverage mask and a color into premultiplied color and per-channel transparency
+void Sprite::premultiply(const Mat& coverage, const Scalar& spriteColor) {
+
+	// size blend planes like coverage
+	color.create(coverage.rows, coverage.cols, CV_8UC3);
+	transparency.create(coverage.rows, coverage.cols, CV_8UC3);
+
+	// iterate through rows
+	for (int y = 0; y < coverage.rows; y++) {
+
+		// row pointers
+		const uchar* covered = coverage.ptr<uchar>(y);
+		uchar* pixel = color.ptr<uchar>(y);
+		uchar* remaining = transparency.ptr<uchar>(y);
+
+		// scale each channel by coverage (rounded), repeat transparency per channel so blits need no division
+		for (int x = 0; x < coverage.cols; x++) {
+			for (int c = 0; c < 3; c++) {
+				pixel[3 * x + c] = static_cast<uchar>((spriteColor[c] * covered[x] + 127) / 255);
+				remaining[3 * x + c] = static_cast<uchar>(255 - covered[x]);
+			}
+		}
+	}
+}
+
+// Finds the frame region the sprite covers when anchored at a point, clipped to the frame
+Rect Sprite::bounds(const Mat& frame, const Point& position) {
+
+	// sprite rectangle at position, clipped
+	return Rect(position.x - anchor.x, position.y - anchor.y, color.cols, color.rows) & Rect(0, 0, frame.cols, frame.rows);
+}
+
+// Alpha blends the sprite onto a 3-channel frame, anchored at a point, returns the region written
+Rect Sprite::blit(Mat& frame, const Point& position) {
+
+	// region of the frame written, and where it starts inside the sprite
+	Rect region = bounds(frame, position);
+	int offsetX = region.x - (position.x - anchor.x);
+	int offsetY = region.y - (position.y - anchor.y);
+
+	// iterate through covered rows
+	for (int y = 0; y < region.height; y++) {
+
+		// row pointers
+		const uchar* source = color.ptr<uchar>(offsetY + y) + 3 * offsetX;
+		const uchar* remaining = transparency.ptr<uchar>(offsetY + y) + 3 * offsetX;
+		uchar* target = frame.ptr<uchar>(region.y + y) + 3 * region.x;
+
+		// blend channels, target = source + target * transparency / 255 (branch-free 16-bit math so the compiler vectorizes it)
+		for (int i = 0; i < 3 * region.width; i++) {
+			unsigned short scaled = static_cast<unsigned short>(target[i] * remaining[i] + 128);
+			target[i] = static_cast<uchar>(source[i] + (static_cast<unsigned short>(scaled + (scaled >> 8)) >> 8));
+		}
+	}
+
+	// report region written
+	return region;
+}
+
+// Reports how far the next glyph starts after this one (text sprites)
+int Sprite::getAdvance() {
+
+	// report advance
+	return advance;
+}
@@ -0,0 +1,41 @@
+#pragma once
+#include "GameData.h"
+
+// Pre-rendered anti-aliased image with an alpha mask, blended onto a frame without rasterizing again
+// Color is stored premultiplied by alpha so a blit is one multiply-add per channel
+class Sprite {
+public:
+
+	// Constructor, empty sprite (blits nothing)
+	Sprite();
+
+	// Renders a circle of a radius (pixels), filled if thickness is negative, anchored at its center
+	void renderCircle(const double, const cv::Scalar&, const int);
+
+	// Renders text in a Hershey font at a scale and thickness, anchored at its baseline origin like putText
+	void renderText(const std::string&, const int, const double, const cv::Scalar&, const int);
+
+	// Finds the frame region the sprite covers when anchored at a point, clipped to the frame
+	cv::Rect bounds(const cv::Mat&, const cv::Point&);
+
+	// Alpha blends the sprite onto a 3-channel frame, anchored at a point, returns the region written
+	cv::Rect blit(cv::Mat&, const cv::Point&);
+
+	// Reports how far the next glyph starts after this one (text sprites)
+	int getAdvance();
+
+private:
+
+	// Converts a rendered coverage mask and a color into premultiplied color and per-channel transparency
+	void premultiply(const cv::Mat&, const cv::Scalar&);
+
+	// premultiplied BGR color, and 255 minus coverage repeated per channel
+	cv::Mat color;
+	cv::Mat transparency;
+
+	// position of the anchor point inside the sprite
+	cv::Point anchor;
+
+	// horizontal advance (text sprites)
+	int advance;
+};
@@ -0,0 +1,73 @@
+#include "SyntheticFrameSource.h"
+
+// Constructor, sets frame size, frame rate and injected delivery delay (ms)
+SyntheticFrameSource::SyntheticFrameSource(const int width, const int height, const double framerate, const double delivery_ms) {
+
+	// store frame size
+	rows = height;
+	cols = width;
+
+	// convert rate and delay to clock durations
+	framePeriod = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(1.0 / framerate));
+	delay = std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double, std::milli>(delivery_ms));
+	delay_ms = delivery_ms;
+
+	// first frame is due immediately
+	startTime = std::chrono::steady_clock::now();
+	nextFrameTime = startTime;
+}
+
+// Waits for the next frame time, draws the flares where they were at capture, returns false never (source doesn't end)
+bool SyntheticFrameSource::readFrame(cv::Mat& frame, std::chrono::steady_clock::time_point& captureTime) {
+
+	// pace frames like a camera
+	std::this_thread::sleep_until(nextFrameTime);
+	nextFrameTime += framePeriod;
+
+	// stamp frame as exposed one delay before delivery
+	captureTime = std::chrono::steady_clock::now() - delay;
+
+	// flare motion phase at capture (one slow circle every two seconds)
+	double phase = std::chrono::duration<double>(captureTime - startTime).count() * CV_PI;
+
+	// clear frame to black (no-op allocation once sized)
+	frame.create(rows, cols, CV_8UC3);
+	frame.setTo(cv::Scalar::all(0));
+
+	// draw flares circling the default paddle positions in sensor space
+	int radius = std::max(3, cols / 70);
+	cv::Point orbit(static_cast<int>(cols / 16 * cos(phase)), static_cast<int>(rows / 8 * sin(phase)));
+	cv::circle(frame, cv::Point(cols / 4, rows / 2) + orbit, radius, cv::Scalar::all(255), -1);
+	cv::circle(frame, cv::Point(cols * 3 / 4, rows / 2) - orbit, radius, cv::Scalar::all(255), -1);
+
+	// report frame ready
+	return true;
+}
+
+// Reports the generated frame rows
+int SyntheticFrameSource::getRows() {
+
+	// report format
+	return rows;
+}
+
+// Reports the generated frame columns
+int SyntheticFrameSource::getCols() {
+
+	// report format
+	return cols;
+}
+
+// Reports the generated frame type
+int SyntheticFrameSource::getType() {
+
+	// synthetic frames are BGR like the camera's
+	return CV_8UC3;
+}
+
+// Reports the injected delivery delay (ms)
+double SyntheticFrameSource::getDelay() {
+
+	// report delay
+	return delay_ms;
+}
@@ -0,0 +1,43 @@
+#pragma once
+#include "GameData.h"
+
+// Generates IR frames with two flares circling the paddle positions, paced like a camera
+// Each frame is stamped a fixed delay before it is delivered, standing in for exposure-to-delivery latency
+class SyntheticFrameSource {
+public:
+
+	// Constructor, sets frame size, frame rate and injected delivery delay (ms)
+	SyntheticFrameSource(const int, const int, const double, const double);
+
+	// Waits for the next frame time, draws the flares where they were at capture, returns false never (source doesn't end)
+	bool readFrame(cv::Mat&, std::chrono::steady_clock::time_point&);
+
+	// Reports the generated frame rows
+	int getRows();
+
+	// Reports the generated frame columns
+	int getCols();
+
+	// Reports the generated frame type
+	int getType();
+
+	// Reports the injected delivery delay (ms)
+	double getDelay();
+
+private:
+
+	// generated frame size
+	int rows;
+	int cols;
+
+	// time between frames
+	std::chrono::steady_clock::duration framePeriod;
+
+	// time between a frame's capture stamp and its delivery
+	std::chrono::steady_clock::duration delay;
+	double delay_ms;
+
+	// delivery time of the next frame, and of the first (flare motion starts there)
+	std::chrono::steady_clock::time_point nextFrameTime;
+	std::chrono::steady_clock::time_point startTime;
+};
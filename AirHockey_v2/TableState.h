@@ -0,0 +1,41 @@
+#pragma once
+#include "SeqLock.h"
+#include "WorldState.h"
+
+// State one table's sensor, physics and graphics share, one per projected table
+struct TableState {
+
+	// gameplay-state flag (SETUP, IN_PLAY, GOAL_ONE, ...)
+	std::atomic<int> gameState;
+
+	// puck and paddle snapshot, published by physics
+	SeqLock<WorldState> world_state;
+
+	// paddle snapshot, published by sensor
+	SeqLock<PaddleState> paddle_state;
+
+	// table dimensions and important points, set by the sensor's calibration before play
+	double table_width, table_height, table_center[2], table_centerLeft[2], table_centerRight[2];
+
+	// game score
+	std::atomic<int> score_playerOne, score_playerTwo;
+
+	// Constructor, in play with no score on an uncalibrated table
+	TableState() : gameState(IN_PLAY), table_width(0), table_height(0), table_center{ 0,0 }, table_centerLeft{ 0,0 }, table_centerRight{ 0,0 }, score_playerOne(0), score_playerTwo(0) {}
+
+	// Sizes the table from the projector's distance, and calculates its important points
+	void setDimensions(const double projectorDistance) {
+
+		// calculate table dimensions from spread and distance
+		table_width = projectorDistance * PROJECTOR_SPREAD_HORIZ;
+		table_height = projectorDistance * PROJECTOR_SPREAD_VERT;
+
+		// calculate important table points
+		table_center[0] = table_width / 2;
+		table_center[1] = table_height / 2;
+		table_centerLeft[0] = table_width / 4;
+		table_centerLeft[1] = table_center[1];
+		table_centerRight[0] = table_width * 3 / 4;
+		table_centerRight[1] = table_center[1];
+	}
+};
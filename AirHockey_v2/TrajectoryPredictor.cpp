@@ -0,0 +1,106 @@
+#include "TrajectoryPredictor.h"
+
+// Constructor, predicts flights on the given table with the given constants
+TrajectoryPredictor::TrajectoryPredictor(const TableState* table, const PhysicsParameters& constants) : tableState(table), parameters(constants) {}
+
+// Predicts where and when a puck first crosses the "vertical" line at the given x, returns false if it stops, scores or bounces too often first
+bool TrajectoryPredictor::predictCrossing(const Vec2& start_position, const Vec2& start_velocity, const double lineX, TrajectoryCrossing& crossing) {
+
+	// calculate limits for the puck center imposed by the walls
+	const Vec2 lowerLimit(parameters.puckRadius + WALL_PADDING_THICKNESS, parameters.puckRadius + WALL_PADDING_THICKNESS);
+	const Vec2 upperLimit(tableState->table_width - parameters.puckRadius - WALL_PADDING_THICKNESS, tableState->table_height - parameters.puckRadius - WALL_PADDING_THICKNESS);
+
+	// friction slows the puck at a constant rate along its path, physics stops it outright once its speed falls to that rate
+	const double deceleration = parameters.puckFriction;
+	const double stopSpeed = parameters.puckFriction;
+
+	// start flight
+	Vec2 position = start_position;
+	Vec2 velocity = start_velocity;
+	double time = 0;
+
+	// follow one straight segment per wall bounce
+	for (int bounces = 0; bounces <= PREDICTOR_MAX_BOUNCES; bounces++) {
+
+		// check if puck has already stopped
+		double speed = velocity.length();
+		if (speed <= stopSpeed)
+			return false;
+
+		// calculate heading and distance the puck still covers before stopping
+		Vec2 direction = velocity / speed;
+		double reach = (deceleration > 0) ? (speed * speed - stopSpeed * stopSpeed) / (2 * deceleration) : std::numeric_limits<double>::infinity();
+
+		// calculate distance along the path to the line, if heading for (or on) it
+		double lineDistance = std::numeric_limits<double>::infinity();
+		if (direction.x != 0 && (lineX - position.x) * direction.x >= 0)
+			lineDistance = (lineX - position.x) / direction.x;
+
+		// calculate distance along the path to the nearest wall the puck is heading for
+		double wallDistance = std::numeric_limits<double>::infinity();
+		int wallAxis = 0;
+		for (int i = 0; i < 2; i++) {
+
+			// find wall on this axis the puck is heading for
+			double distance;
+			if (direction[i] < 0)
+				distance = (lowerLimit[i] - position[i]) / direction[i];
+			else if (direction[i] > 0)
+				distance = (upperLimit[i] - position[i]) / direction[i];
+			else
+				continue;
+
+			// record as nearest wall (a puck already touching it bounces straight away)
+			if (std::max(distance, 0.0) < wallDistance) {
+				wallDistance = std::max(distance, 0.0);
+				wallAxis = i;
+			}
+		}
+
+		// check if the line comes first
+		if (lineDistance <= wallDistance) {
+
+			// check if puck stops short of the line
+			if (lineDistance > reach)
+				return false;
+
+			// report crossing
+			double elapsed = travelTime(speed, lineDistance);
+			crossing.position = position + direction * lineDistance;
+			crossing.position.x = lineX;
+			crossing.velocity = direction * (speed - deceleration * elapsed);
+			crossing.time = time + elapsed;
+			crossing.bounces = bounces;
+			return true;
+		}
+
+		// check if puck stops short of the wall
+		if (wallDistance > reach)
+			return false;
+
+		// move puck to the wall
+		double elapsed = travelTime(speed, wallDistance);
+		position += direction * wallDistance;
+		velocity = direction * (speed - deceleration * elapsed);
+		time += elapsed;
+
+		// check if a "vertical" wall contact is actually in a goal mouth (puck scores)
+		if (wallAxis == 0 && position.y <= (tableState->table_height + parameters.goalWidth) / 2 && position.y >= (tableState->table_height - parameters.goalWidth) / 2)
+			return false;
+
+		// place puck exactly against the wall, invert velocity normal to the wall, attenuate by elasticity
+		position[wallAxis] = (direction[wallAxis] < 0) ? lowerLimit[wallAxis] : upperLimit[wallAxis];
+		velocity[wallAxis] *= (-1.0 * parameters.wallElasticity);
+	}
+
+	// report too many bounces to follow
+	return false;
+}
+
+// Calculates the time a puck at the given speed takes to cover a distance under friction (distance must be reachable)
+double TrajectoryPredictor::travelTime(const double speed, const double distance) {
+
+	// solve speed * t - friction * t^2 / 2 = distance for the first root, in the form that stays accurate when friction is tiny
+	double discriminant = std::max(speed * speed - 2 * parameters.puckFriction * distance, 0.0);
+	return 2 * distance / (speed + std::sqrt(discriminant));
+}
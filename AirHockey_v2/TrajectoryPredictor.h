@@ -0,0 +1,35 @@
+#pragma once
+#include "GameData.h"
+#include "Physics.h"
+#include <limits>
+
+// Where and when a puck's free flight crosses a line
+struct TrajectoryCrossing {
+	Vec2 position;		// puck center on the line
+	Vec2 velocity;		// puck velocity as it crosses
+	double time;		// time (secs) from the start of the flight
+	int bounces;		// wall bounces on the way
+};
+
+// Closed-form puck flight predictor, follows friction and wall bounces segment by segment without stepping physics
+// Paddles and other pucks are ignored, a prediction is the puck's path if nothing touches it
+class TrajectoryPredictor {
+public:
+
+	// Constructor, predicts flights on the given table with the given constants
+	TrajectoryPredictor(const TableState*, const PhysicsParameters& = PhysicsParameters());
+
+	// Predicts where and when a puck first crosses the "vertical" line at the given x, returns false if it stops, scores or bounces too often first
+	bool predictCrossing(const Vec2&, const Vec2&, const double, TrajectoryCrossing&);
+
+private:
+
+	// Calculates the time a puck at the given speed takes to cover a distance under friction (distance must be reachable)
+	double travelTime(const double, const double);
+
+	// table whose walls and goals the puck flies between
+	const TableState* tableState;
+
+	// constants the predicted physics runs with
+	PhysicsParameters parameters;
+};
@@ -0,0 +1,64 @@
+#pragma once
+#include <cmath>
+
+// 2D vector for positions and velocities, 16-byte aligned so x and y fill one SIMD register
+struct alignas(16) Vec2 {
+
+	// components
+	double x, y;
+
+	// Constructors, zero vector or given components
+	constexpr Vec2() : x(0.0), y(0.0) {}
+	constexpr Vec2(const double x_, const double y_) : x(x_), y(y_) {}
+
+	// component access by axis index (0 = "horizontal", 1 = "vertical")
+	constexpr double& operator[](const int axis) { return axis == 0 ? x : y; }
+	constexpr const double& operator[](const int axis) const { return axis == 0 ? x : y; }
+
+	// arithmetic
+	constexpr Vec2 operator+(const Vec2& other) const { return Vec2(x + other.x, y + other.y); }
+	constexpr Vec2 operator-(const Vec2& other) const { return Vec2(x - other.x, y - other.y); }
+	constexpr Vec2 operator-() const { return Vec2(-x, -y); }
+	constexpr Vec2 operator*(const double scale) const { return Vec2(x * scale, y * scale); }
+	constexpr Vec2 operator/(const double scale) const { return Vec2(x / scale, y / scale); }
+	constexpr Vec2& operator+=(const Vec2& other) { x += other.x; y += other.y; return *this; }
+	constexpr Vec2& operator-=(const Vec2& other) { x -= other.x; y -= other.y; return *this; }
+	constexpr Vec2& operator*=(const double scale) { x *= scale; y *= scale; return *this; }
+
+	// dot product
+	constexpr double dot(const Vec2& other) const { return x * other.x + y * other.y; }
+
+	// squared length, use for comparisons to avoid a sqrt
+	constexpr double lengthSquared() const { return x * x + y * y; }
+
+	// length
+	double length() const { return std::sqrt(lengthSquared()); }
+
+	// reflection across a line with the given unit normal
+	constexpr Vec2 reflect(const Vec2& unitNormal) const { return *this - unitNormal * (2.0 * dot(unitNormal)); }
+};
+
+// scalar-first multiplication
+constexpr Vec2 operator*(const double scale, const Vec2& v) { return v * scale; }
+
+// Advances a batch of bodies by their velocities (loop is branch-free so it vectorizes)
+inline void advanceBodies(Vec2* positions, const Vec2* velocities, const int count, const double deltaTime_secs) {
+
+	// move every body along its velocity
+	for (int i = 0; i < count; i++)
+		positions[i] += velocities[i] * deltaTime_secs;
+}
+
+// Slows a batch of bodies by a constant deceleration, stopping any slower than stopSpeed (or that would reverse)
+inline void applyFriction(Vec2* velocities, const int count, const double deceleration, const double stopSpeed, const double deltaTime_secs) {
+
+	// speed lost this step
+	const double speedLoss = deceleration * deltaTime_secs;
+
+	// scale every velocity towards zero along its own direction
+	for (int i = 0; i < count; i++) {
+		double speed = velocities[i].length();
+		double scale = (speed > stopSpeed && speed > speedLoss) ? (speed - speedLoss) / speed : 0.0;
+		velocities[i] *= scale;
+	}
+}
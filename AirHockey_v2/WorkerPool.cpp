@@ -0,0 +1,132 @@
+#include "WorkerPool.h"
+
+// pool and worker index of the calling thread (NULL and -1 outside any pool)
+static thread_local WorkerPool* currentPool = NULL;
+static thread_local int currentWorker = -1;
+
+// Constructor, starts the given number of workers (0 starts one per hardware thread)
+WorkerPool::WorkerPool(const int workerCount) : queuedTasks(0), stopping(false), nextQueue(0), stealCount(0) {
+
+	// size pool to the machine if no count was given (hardware_concurrency may report 0)
+	int count = workerCount;
+	if (count <= 0)
+		count = std::max(1, static_cast<int>(std::thread::hardware_concurrency()));
+
+	// create every queue before any worker can steal from it
+	for (int i = 0; i < count; i++)
+		queues.push_back(new TaskQueue());
+
+	// start workers
+	for (int i = 0; i < count; i++)
+		workers.push_back(std::thread(&WorkerPool::workerLoop, this, i));
+}
+
+// Destructor, stops workers once their current tasks finish, drops tasks still queued
+WorkerPool::~WorkerPool() {
+
+	// flag workers to stop and wake every sleeping one
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		stopping = true;
+	}
+	taskReady.notify_all();
+
+	// wait for workers to finish their current tasks
+	for (size_t i = 0; i < workers.size(); i++)
+		workers[i].join();
+
+	// release queues
+	for (size_t i = 0; i < queues.size(); i++)
+		delete queues[i];
+}
+
+// Queues a task, on the calling worker's own queue when called from a worker, otherwise spread round-robin
+void WorkerPool::submit(const std::function<void()>& task) {
+
+	// pick queue, a worker keeps its own follow-up work (cache-warm), outside threads spread theirs
+	int queue = (currentPool == this) ? currentWorker : static_cast<int>(nextQueue++ % queues.size());
+
+	// append task
+	{
+		std::lock_guard<std::mutex> lock(queues[queue]->lock);
+		queues[queue]->tasks.push_back(task);
+	}
+
+	// count task and wake one sleeping worker (any worker can take it)
+	{
+		std::lock_guard<std::mutex> lock(sleepLock);
+		queuedTasks++;
+	}
+	taskReady.notify_one();
+}
+
+// Reports the number of worker threads
+int WorkerPool::getWorkerCount() {
+
+	// report pool size
+	return static_cast<int>(workers.size());
+}
+
+// Reports how many tasks were run by a worker other than the one they were queued on
+unsigned long WorkerPool::getStealCount() {
+
+	// report running total
+	return stealCount.load();
+}
+
+// Runs tasks until the pool stops
+void WorkerPool::workerLoop(const int index) {
+
+	// let submit() find this worker's own queue
+	currentPool = this;
+	currentWorker = index;
+
+	// iterate until the pool stops
+	while (true) {
+
+		// sleep until a task is queued, claim it
+		{
+			std::unique_lock<std::mutex> lock(sleepLock);
+			taskReady.wait(lock, [this] { return queuedTasks > 0 || stopping; });
+			if (stopping)
+				return;
+			queuedTasks--;
+		}
+
+		// find a task, every claim is backed by one queued before it was counted (another worker may be taking a neighbour)
+		std::function<void()> task;
+		while (!takeTask(index, task))
+			std::this_thread::yield();
+
+		// run task
+		task();
+	}
+}
+
+// Takes the oldest task from the worker's own queue, or else from another worker's, returns false if every queue is empty
+bool WorkerPool::takeTask(const int index, std::function<void()>& task) {
+
+	// visit own queue first, then the others in order (oldest task first everywhere, so no queued table waits behind newer work)
+	for (size_t i = 0; i < queues.size(); i++) {
+		TaskQueue* queue = queues[(index + i) % queues.size()];
+		std::lock_guard<std::mutex> lock(queue->lock);
+
+		// check if queue has a task
+		if (queue->tasks.empty())
+			continue;
+
+		// take oldest task
+		task = std::move(queue->tasks.front());
+		queue->tasks.pop_front();
+
+		// count tasks taken from another worker
+		if (i > 0)
+			stealCount++;
+
+		// report task found
+		return true;
+	}
+
+	// report every queue empty
+	return false;
+}
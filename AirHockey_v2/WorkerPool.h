@@ -0,0 +1,60 @@
+#pragma once
+#include "GameData.h"
+#include <deque>
+#include <functional>
+#include <vector>
+
+// Work-stealing thread pool shared by every table's sensor and physics work
+// Each worker has its own task queue, an idle worker steals from the others before sleeping
+class WorkerPool {
+public:
+
+	// Constructor, starts the given number of workers (0 starts one per hardware thread)
+	WorkerPool(const int);
+
+	// Destructor, stops workers once their current tasks finish, drops tasks still queued
+	~WorkerPool();
+
+	// Queues a task, on the calling worker's own queue when called from a worker, otherwise spread round-robin
+	void submit(const std::function<void()>&);
+
+	// Reports the number of worker threads
+	int getWorkerCount();
+
+	// Reports how many tasks were run by a worker other than the one they were queued on
+	unsigned long getStealCount();
+
+private:
+
+	// One worker's tasks, oldest at the front
+	struct TaskQueue {
+		std::deque<std::function<void()>> tasks;
+		std::mutex lock;
+	};
+
+	// Runs tasks until the pool stops
+	void workerLoop(const int);
+
+	// Takes the oldest task from the worker's own queue, or else from another worker's, returns false if every queue is empty
+	bool takeTask(const int, std::function<void()>&);
+
+	// task queues, one per worker
+	std::vector<TaskQueue*> queues;
+
+	// worker threads
+	std::vector<std::thread> workers;
+
+	// guards the queued task count and stop flag, wakes sleeping workers
+	std::mutex sleepLock;
+	std::condition_variable taskReady;
+
+	// tasks queued and not yet claimed by a worker, and stop flag (guarded by sleepLock)
+	int queuedTasks;
+	bool stopping;
+
+	// queue the next task from outside the pool goes on
+	std::atomic<unsigned int> nextQueue;
+
+	// number of stolen tasks
+	std::atomic<unsigned long> stealCount;
+};
@@ -0,0 +1,43 @@
+#pragma once
+#include "SeqLock.h"
+#include "Vec2.h"
+
+// Steady-clock times (secs) one camera frame reached each pipeline stage, for motion-to-photon accounting
+struct FrameTrace {
+	double captured;	// frame exposed (camera) or recorded capture time (replay)
+	double taken;		// sensor thread took the frame from the queue
+	double published;	// paddle estimates from the frame were published
+	double stepped;		// first physics step that used the estimates ran
+};
+
+// Filtered paddle positions and velocities, published by the sensor thread
+struct PaddleState {
+
+	// paddle position and velocity vectors
+	Vec2 paddleOne_position, paddleOne_velocity;
+	Vec2 paddleTwo_position, paddleTwo_velocity;
+
+	// detection confidence (0 lost, 1 steadily tracked)
+	double paddleOne_confidence, paddleTwo_confidence;
+
+	// times the camera frame the estimates describe passed each stage so far
+	FrameTrace trace;
+};
+
+// Puck and paddle positions and velocities, published by the physics thread
+struct WorldState {
+
+	// puck position and velocity vectors, one entry per puck in separate arrays so batch kernels stream them
+	Vec2 puck_positions[PHYSICS_MAX_PUCKS];
+	Vec2 puck_velocities[PHYSICS_MAX_PUCKS];
+
+	// number of pucks in play (1 outside multi-puck mode)
+	int puck_count;
+
+	// paddle position and velocity vectors (as used for the physics step)
+	Vec2 paddleOne_position, paddleOne_velocity;
+	Vec2 paddleTwo_position, paddleTwo_velocity;
+
+	// times the camera frame behind the paddles passed each stage so far
+	FrameTrace trace;
+};
@@ -0,0 +1,158 @@
+#include "AllocationCounter.h"
+#include <atomic>
+#include <cerrno>
+#include <cstdlib>
+#include <new>
+
+// check if a sanitizer replaces the C allocator (a forwarding replacement would bypass it)
+#if defined(__SANITIZE_ADDRESS__) || defined(__SANITIZE_THREAD__)
+	#define ALLOCATION_COUNTER_SANITIZED
+#elif defined(__has_feature)
+	#if __has_feature(address_sanitizer) || __has_feature(thread_sanitizer)
+		#define ALLOCATION_COUNTER_SANITIZED
+	#endif
+#endif
+
+// check if the C allocator can be counted, glibc's internal entry points let a replacement forward without recursing
+#if defined(__GLIBC__) && !defined(ALLOCATION_COUNTER_SANITIZED)
+	#define ALLOCATION_COUNTER_MALLOC
+#endif
+
+// heap allocations made by the process, counted by the replaced allocation functions
+static std::atomic<unsigned long> allocationCount(0);
+
+#ifdef ALLOCATION_COUNTER_MALLOC
+
+// glibc allocator entry points, the replacements below forward to them (free is left to glibc)
+extern "C" void* __libc_malloc(size_t);
+extern "C" void* __libc_calloc(size_t, size_t);
+extern "C" void* __libc_realloc(void*, size_t);
+extern "C" void* __libc_memalign(size_t, size_t);
+
+// Counting replacement for malloc (operator new and cv::fastMalloc end up here)
+extern "C" void* malloc(size_t size) noexcept {
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return __libc_malloc(size);
+}
+
+// Counting replacement for calloc
+extern "C" void* calloc(size_t count, size_t size) noexcept {
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return __libc_calloc(count, size);
+}
+
+// Counting replacement for realloc (every call may move the block)
+extern "C" void* realloc(void* memory, size_t size) noexcept {
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return __libc_realloc(memory, size);
+}
+
+// Counting replacement for posix_memalign (cv::fastMalloc uses it where available)
+extern "C" int posix_memalign(void** memory, size_t alignment, size_t size) noexcept {
+
+	// check alignment is a power of two multiple of the pointer size, as required
+	if (alignment % sizeof(void*) != 0 || (alignment & (alignment - 1)) != 0)
+		return EINVAL;
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	void* block = __libc_memalign(alignment, size);
+	if (block == NULL)
+		return ENOMEM;
+	*memory = block;
+	return 0;
+}
+
+// Counting replacement for aligned_alloc
+extern "C" void* aligned_alloc(size_t alignment, size_t size) noexcept {
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return __libc_memalign(alignment, size);
+}
+
+// Counting replacement for memalign
+extern "C" void* memalign(size_t alignment, size_t size) noexcept {
+
+	// count allocation, forward to glibc
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+	return __libc_memalign(alignment, size);
+}
+
+#else
+
+// Counting replacement for global operator new
+void* operator new(std::size_t size) {
+
+	// count allocation
+	allocationCount.fetch_add(1, std::memory_order_relaxed);
+
+	// allocate (at least one byte, as required)
+	void* memory = malloc(size ? size : 1);
+	if (memory == NULL)
+		throw std::bad_alloc();
+	return memory;
+}
+
+// Counting replacement for global operator new[]
+void* operator new[](std::size_t size) {
+
+	// share scalar allocation path
+	return operator new(size);
+}
+
+// Replacement for global operator delete, matches operator new
+void operator delete(void* memory) noexcept {
+
+	// release memory
+	free(memory);
+}
+
+// Replacement for global operator delete[], matches operator new[]
+void operator delete[](void* memory) noexcept {
+
+	// release memory
+	free(memory);
+}
+
+// Replacement for sized global operator delete, matches operator new
+void operator delete(void* memory, std::size_t) noexcept {
+
+	// release memory
+	free(memory);
+}
+
+// Replacement for sized global operator delete[], matches operator new[]
+void operator delete[](void* memory, std::size_t) noexcept {
+
+	// release memory
+	free(memory);
+}
+
+#endif
+
+// Reports number of heap allocations made by the process so far
+unsigned long AllocationCounter::getCount() {
+
+	// report running total
+	return allocationCount.load(std::memory_order_relaxed);
+}
+
+// Reports whether C allocator calls (and so OpenCV buffers) are counted, not just operator new
+bool AllocationCounter::countsMalloc() {
+#ifdef ALLOCATION_COUNTER_MALLOC
+
+	// C allocator replaced
+	return true;
+#else
+
+	// only operator new replaced
+	return false;
+#endif
+}
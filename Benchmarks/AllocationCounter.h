@@ -0,0 +1,14 @@
+#pragma once
+
+// Process-wide heap allocation counter, replaces the global allocation functions of any executable linking it
+// On glibc the C allocator itself is counted, so buffers OpenCV allocates with cv::fastMalloc (Mat data) are included,
+// elsewhere (and under sanitizers, which own the C allocator) only operator new is counted
+class AllocationCounter {
+public:
+
+	// Reports number of heap allocations made by the process so far
+	static unsigned long getCount();
+
+	// Reports whether C allocator calls (and so OpenCV buffers) are counted, not just operator new
+	static bool countsMalloc();
+};
@@ -0,0 +1,82 @@
+#include "Benchmark.h"
+#include "AllocationCounter.h"
+#include <iomanip>
+
+// Constructor, takes a name filter (empty runs everything) and a quick flag (fewer batches, for smoke runs)
+Benchmark::Benchmark(const std::string& nameFilter, const bool quickRun) {
+
+	// store run options
+	filter = nameFilter;
+	quick = quickRun;
+}
+
+// Sorts the current samples and appends a result
+void Benchmark::record(const std::string& name, const unsigned long operations, const unsigned long allocations) {
+
+	// order samples for percentile lookup
+	std::sort(samples.begin(), samples.end());
+
+	// mean of batch times weighs every batch equally (all batches hold the same number of operations)
+	double total = 0;
+	for (size_t i = 0; i < samples.size(); i++)
+		total += samples[i];
+
+	// fill in result
+	BenchmarkResult result;
+	result.name = name;
+	result.operations = operations;
+	result.mean_ns = total / samples.size();
+	result.p50_ns = samples[(samples.size() - 1) * 50 / 100];
+	result.p90_ns = samples[(samples.size() - 1) * 90 / 100];
+	result.p99_ns = samples[(samples.size() - 1) * 99 / 100];
+	result.max_ns = samples.back();
+	result.allocationsPerOp = static_cast<double>(allocations) / operations;
+	results.push_back(result);
+
+	// show progress as benchmarks finish
+	std::cout << "finished " << name << std::endl;
+}
+
+// Prints a human-readable results table
+void Benchmark::printTable(std::ostream& out) {
+
+	// print header
+	out << std::left << std::setw(44) << "benchmark" << std::right << std::setw(12) << "mean ns" << std::setw(12) << "p50 ns" << std::setw(12) << "p90 ns" << std::setw(12) << "p99 ns" << std::setw(12) << "max ns" << std::setw(12) << "allocs/op" << std::endl;
+
+	// print one row per result
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& r = results[i];
+		out << std::left << std::setw(44) << r.name << std::right << std::fixed << std::setprecision(1) << std::setw(12) << r.mean_ns << std::setw(12) << r.p50_ns << std::setw(12) << r.p90_ns << std::setw(12) << r.p99_ns << std::setw(12) << r.max_ns << std::setprecision(3) << std::setw(12) << r.allocationsPerOp << std::endl;
+	}
+
+	// check if OpenCV buffers went uncounted, say so (their reallocations wouldn't show in allocs/op)
+	if (!AllocationCounter::countsMalloc())
+		out << "note: allocs/op counts operator new only, cv::Mat buffers are not included on this platform" << std::endl;
+}
+
+// Writes results as a JSON array, returns false if the file can't be written
+bool Benchmark::writeJson(const std::string& path) {
+
+	// open output file
+	std::ofstream out(path.c_str());
+	if (!out.good())
+		return false;
+
+	// write one object per result (names are plain identifiers, no escaping needed)
+	out << "[" << std::endl;
+	for (size_t i = 0; i < results.size(); i++) {
+		const BenchmarkResult& r = results[i];
+		out << "  {\"name\": \"" << r.name << "\", \"operations\": " << r.operations << std::setprecision(6) << ", \"mean_ns\": " << r.mean_ns << ", \"p50_ns\": " << r.p50_ns << ", \"p90_ns\": " << r.p90_ns << ", \"p99_ns\": " << r.p99_ns << ", \"max_ns\": " << r.max_ns << ", \"allocs_per_op\": " << r.allocationsPerOp << "}" << (i + 1 < results.size() ? "," : "") << std::endl;
+	}
+	out << "]" << std::endl;
+
+	// report write success
+	return out.good();
+}
+
+// Reports number of heap allocations made by the process so far (C allocator included where AllocationCounter can count it)
+unsigned long Benchmark::getAllocationCount() {
+
+	// report process-wide count
+	return AllocationCounter::getCount();
+}
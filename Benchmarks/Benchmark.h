@@ -0,0 +1,104 @@
+#pragma once
+#include "GameData.h"
+#include <vector>
+#include <algorithm>
+
+// Result of one benchmark, per-operation times in nanoseconds
+struct BenchmarkResult {
+	std::string name;			// benchmark name (group/case)
+	unsigned long operations;	// timed operations
+	double mean_ns;				// mean time per operation
+	double p50_ns;				// median batch time per operation
+	double p90_ns;				// 90th percentile batch time per operation
+	double p99_ns;				// 99th percentile batch time per operation
+	double max_ns;				// slowest batch time per operation
+	double allocationsPerOp;	// heap allocations per operation
+};
+
+// Headless benchmark harness, times batches of operations and reports ns/op, percentiles and allocations
+class Benchmark {
+public:
+
+	// Constructor, takes a name filter (empty runs everything) and a quick flag (fewer batches, for smoke runs)
+	Benchmark(const std::string&, const bool);
+
+	// Times an operation in batches, calling setup (untimed) before each batch
+	template <typename Setup, typename Op>
+	void run(const std::string& name, const int batchSize, int batches, Setup setup, Op op) {
+
+		// check if benchmark was filtered out
+		if (!filter.empty() && name.find(filter) == std::string::npos)
+			return;
+
+		// shorten run for smoke tests
+		if (quick)
+			batches = std::max(1, batches / 50);
+
+		// warm caches and let buffers reach their steady-state size
+		for (int i = 0; i < 3; i++) {
+			setup();
+			for (int j = 0; j < batchSize; j++)
+				op();
+		}
+
+		// reuse sample storage so the harness doesn't allocate while timing
+		samples.clear();
+		samples.reserve(batches);
+		unsigned long allocations = 0;
+
+		// iterate through batches
+		for (int i = 0; i < batches; i++) {
+
+			// prepare batch outside the timed region
+			setup();
+
+			// time batch and count its allocations
+			unsigned long allocationsBefore = getAllocationCount();
+			auto start = std::chrono::steady_clock::now();
+			for (int j = 0; j < batchSize; j++)
+				op();
+			auto end = std::chrono::steady_clock::now();
+			allocations += getAllocationCount() - allocationsBefore;
+
+			// record per-operation time of batch
+			samples.push_back(std::chrono::duration<double, std::nano>(end - start).count() / batchSize);
+		}
+
+		// summarize samples
+		record(name, static_cast<unsigned long>(batchSize) * batches, allocations);
+	}
+
+	// Times an operation in batches that need no setup
+	template <typename Op>
+	void run(const std::string& name, const int batchSize, const int batches, Op op) {
+
+		// run with an empty setup
+		run(name, batchSize, batches, [] {}, op);
+	}
+
+	// Prints a human-readable results table
+	void printTable(std::ostream&);
+
+	// Writes results as a JSON array, returns false if the file can't be written
+	bool writeJson(const std::string&);
+
+	// Reports number of heap allocations made by the process so far (C allocator included where AllocationCounter can count it)
+	static unsigned long getAllocationCount();
+
+private:
+
+	// Sorts the current samples and appends a result
+	void record(const std::string&, const unsigned long, const unsigned long);
+
+	// substring a benchmark name must contain to run
+	std::string filter;
+
+	// flag for shortened smoke runs
+	bool quick;
+
+	// per-operation batch times of the current benchmark
+	std::vector<double> samples;
+
+	// finished benchmark results
+	std::vector<BenchmarkResult> results;
+};
@@ -0,0 +1,487 @@
+#include "Benchmark.h"
+#include "Fixtures.h"
+#include "Physics.h"
+#include "TrajectoryPredictor.h"
+#include "CameraCalibration.h"
+#include "Sensor.h"
+#ifdef AIRHOCKEY_GUI
+#include "Graphics.h"
+#endif
+
+// state of the benchmarked table (dimensions, paddle input, published world)
+TableState table;
+
+// fixed physics step (us), same as the game loop
+static const long double stepDuration_micros = 1e6L / (GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO);
+
+// Sets table dimensions the way the sensor calibrates them (projector at its default distance)
+void setupTable() {
+
+	// size table and its important points
+	table.setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+}
+
+// Benchmarks Physics::tick and handleCollisions over scripted collision scenarios
+void benchmarkPhysics(Benchmark& bench) {
+
+	// parked paddles, well away from the puck's path
+	const Vec2 paddleOne_parked(table.table_width / 4, table.table_height / 2);
+	const Vec2 paddleTwo_parked(table.table_width * 3 / 4, table.table_height / 2);
+	placePaddles(table, paddleOne_parked, paddleTwo_parked, Vec2());
+
+	// create physics instance
+	Physics physics(&table);
+
+	// puck gliding across open table (friction and integration only)
+	bench.run("physics/tick_free_glide", 256, 2000,
+		[&] { physics.launchPuck(0, Vec2(table.table_width / 2, table.table_height / 4), Vec2(150, 20)); },
+		[&] { physics.tick(stepDuration_micros, 0); });
+
+	// puck hitting the top wall within the step
+	const double wallContact = WALL_PADDING_THICKNESS + PUCK_RADIUS;
+	bench.run("physics/tick_wall_bounce", 1, 200000,
+		[&] { physics.launchPuck(0, Vec2(table.table_width / 2, wallContact + 0.5), Vec2(30, -600)); },
+		[&] { physics.tick(stepDuration_micros, 0); });
+
+	// puck running into a stationary paddle within the step
+	bench.run("physics/tick_paddle_hit", 1, 200000,
+		[&] { physics.launchPuck(0, paddleOne_parked + Vec2(PUCK_RADIUS + PADDLE_RADIUS + 0.5, 3), Vec2(-600, 0)); },
+		[&] { physics.tick(stepDuration_micros, 0); });
+
+	// worst case: paddle pins puck against a side wall, puck must be slid out along the wall
+	const Vec2 pinnedPuck(wallContact, table.table_height / 2 + GOAL_WIDTH);
+	bench.run("physics/tick_pinned_depenetration", 1, 200000,
+		[&] {
+			placePaddles(table, pinnedPuck + Vec2(PUCK_RADIUS + PADDLE_RADIUS - 10, 2), paddleTwo_parked, Vec2(-500, 0));
+			physics.launchPuck(0, pinnedPuck, Vec2());
+		},
+		[&] { physics.tick(stepDuration_micros, 0); });
+
+	// overlap resolved by the fallback collision pass alone
+	placePaddles(table, paddleOne_parked, paddleTwo_parked, Vec2());
+	physics.tick(stepDuration_micros, 0);
+	bench.run("physics/handle_collisions_overlap", 1, 200000,
+		[&] { physics.launchPuck(0, paddleOne_parked + Vec2(PUCK_RADIUS + PADDLE_RADIUS - 5, 4), Vec2(-300, 10)); },
+		[&] { physics.handleCollisions(); });
+
+	// no contact, cost of checking alone
+	bench.run("physics/handle_collisions_none", 256, 2000,
+		[&] { physics.launchPuck(0, Vec2(table.table_width / 2, table.table_height / 2), Vec2(100, 0)); },
+		[&] { physics.handleCollisions(); });
+}
+
+// Benchmarks Physics::tick as the number of pucks grows (multi-puck mode), pucks racked and scattering
+void benchmarkMultiPuck(Benchmark& bench) {
+
+	// parked paddles at their default positions
+	placePaddles(table, Vec2(table.table_width / 4, table.table_height / 2), Vec2(table.table_width * 3 / 4, table.table_height / 2), Vec2());
+
+	// iterate through puck counts
+	const int counts[5] = { 1, 4, 16, 32, PHYSICS_MAX_PUCKS };
+	for (int c = 0; c < 5; c++) {
+
+		// create physics instance with a full rack
+		Physics physics(&table, counts[c]);
+
+		// rack pucks before each batch and send them off in a fan of directions, so they hit walls, paddles and each other
+		auto scatter = [&] {
+			physics.rackPucks();
+			WorldState world = table.world_state.load();
+			for (int i = 0; i < counts[c]; i++) {
+				double angle = 2.399963 * i;	// golden angle (radians), spreads directions evenly
+				physics.launchPuck(i, world.puck_positions[i], Vec2(cos(angle), sin(angle)) * 600);
+			}
+		};
+
+		// one second of play per batch (per op: one tick with every puck)
+		bench.run("physics/tick_pucks_" + std::to_string(counts[c]), GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO, 100,
+			scatter,
+			[&] { physics.tick(stepDuration_micros, 0); });
+	}
+}
+
+// Steps physics until the puck crosses the "vertical" line at the given x, returns false if it stops or scores first (brute-force reference for the predictor)
+bool stepToCrossing(Physics& physics, const Vec2& position, const Vec2& velocity, const double lineX, TrajectoryCrossing& crossing) {
+
+	// launch puck, give up after ten seconds of flight
+	physics.launchPuck(0, position, velocity);
+	const WorldState& state = physics.getState();
+	const double stepDuration_secs = static_cast<double>(stepDuration_micros * 1e-6);
+	for (int step = 0; step < 10 * GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO; step++) {
+
+		// step physics
+		Vec2 lastPosition = state.puck_positions[0];
+		physics.tick(stepDuration_micros, 0);
+		const Vec2& puck_position = state.puck_positions[0];
+
+		// check if puck crossed the line this step, interpolate where and when
+		if ((lastPosition.x - lineX) * (puck_position.x - lineX) <= 0 && lastPosition.x != puck_position.x) {
+			double fraction = (lineX - lastPosition.x) / (puck_position.x - lastPosition.x);
+			crossing.position = lastPosition + (puck_position - lastPosition) * fraction;
+			crossing.velocity = state.puck_velocities[0];
+			crossing.time = (step + fraction) * stepDuration_secs;
+			crossing.bounces = 0;
+			return true;
+		}
+
+		// check if puck stopped or scored
+		if (state.puck_velocities[0].lengthSquared() == 0 || physics.detectGoals() != 0)
+			return false;
+	}
+
+	// report no crossing within the time limit
+	return false;
+}
+
+// Benchmarks the closed-form puck flight predictor against stepping physics, returns false if they disagree by more than allowed
+bool benchmarkPredictor(Benchmark& bench) {
+
+	// largest allowed crossing errors, position (units) and time (secs, continuous vs per-step friction stays well under this)
+	const double maxPositionError = 0.01;
+	const double maxTimeError = 1e-3;
+
+	// paddles parked off the table, so the puck flies free
+	placePaddles(table, Vec2(-1000, -1000), Vec2(-1000, -1000), Vec2());
+
+	// create physics and predictor for the same table
+	Physics physics(&table);
+	TrajectoryPredictor predictor(&table);
+
+	// CPU opponent's defence line in front of paddle one's goal
+	const double lineX = WALL_PADDING_THICKNESS + PADDLE_AI_DEFENSE_DEPTH * PADDLE_RADIUS;
+
+	// fan of shots from the far half towards the line, straight and banked off the "horizontal" walls
+	std::vector<Vec2> shotPositions, shotVelocities;
+	for (int y = 0; y < 5; y++)
+		for (int a = 0; a < 9; a++)
+			for (int v = 0; v < 4; v++) {
+				double angle = CV_PI + (a - 4) * 0.15;
+				shotPositions.push_back(Vec2(table.table_width * 3 / 4, table.table_height * (0.2 + 0.15 * y)));
+				shotVelocities.push_back(Vec2(cos(angle), sin(angle)) * (400.0 + 500.0 * v));
+			}
+
+	// compare predictions with stepped flights
+	int agreed = 0, disagreed = 0, banked = 0;
+	double worstPosition = 0, worstTime = 0;
+	for (size_t i = 0; i < shotPositions.size(); i++) {
+		TrajectoryCrossing predicted, stepped;
+		bool predictedHit = predictor.predictCrossing(shotPositions[i], shotVelocities[i], lineX, predicted);
+		bool steppedHit = stepToCrossing(physics, shotPositions[i], shotVelocities[i], lineX, stepped);
+
+		// check both agree on whether the puck gets there
+		if (predictedHit != steppedHit) {
+			disagreed++;
+			continue;
+		}
+		if (!predictedHit)
+			continue;
+
+		// track largest errors
+		agreed++;
+		banked += (predicted.bounces > 0) ? 1 : 0;
+		worstPosition = std::max(worstPosition, (predicted.position - stepped.position).length());
+		worstTime = std::max(worstTime, std::abs(predicted.time - stepped.time));
+	}
+
+	// check every shot agrees within the allowed errors
+	bool accurate = (disagreed == 0 && agreed > 0 && worstPosition <= maxPositionError && worstTime <= maxTimeError);
+
+	// report accuracy
+	std::cout << "predictor accuracy: " << agreed << " crossings (" << banked << " banked), max error " << worstPosition << " units / "
+		<< worstTime * 1000 << " ms, " << disagreed << " of " << shotPositions.size() << " shots disagree on reaching the line"
+		<< (accurate ? "" : " FAILED") << std::endl;
+
+	// a shot banking off both "horizontal" walls before reaching the line
+	const Vec2 bankPosition(table.table_width * 3 / 4, table.table_height * 0.3);
+	const Vec2 bankVelocity = Vec2(cos(CV_PI - 0.6), sin(CV_PI - 0.6)) * 1400.0;
+	TrajectoryCrossing crossing;
+
+	// predict crossing in closed form (per op: one prediction)
+	bench.run("predictor/crossing_bank", 256, 2000,
+		[&] { predictor.predictCrossing(bankPosition, bankVelocity, lineX, crossing); });
+
+	// same crossing found by stepping physics (per op: one whole flight)
+	bench.run("predictor/brute_force_bank", 1, 200,
+		[&] { stepToCrossing(physics, bankPosition, bankVelocity, lineX, crossing); });
+
+	// report whether predictions were accurate
+	return accurate;
+}
+
+// Benchmarks the Vec2 integration kernels over a block of bodies
+void benchmarkVec2(Benchmark& bench) {
+
+	// bodies spread over the table, all moving
+	std::vector<Vec2> positions(256), velocities(256);
+	for (size_t i = 0; i < positions.size(); i++) {
+		positions[i] = Vec2(static_cast<double>(i), static_cast<double>(i) * 0.5);
+		velocities[i] = Vec2(100 + static_cast<double>(i), -50);
+	}
+
+	// integrate positions (per op: 256 bodies)
+	bench.run("vec2/advance_bodies_256", 64, 2000,
+		[&] { advanceBodies(positions.data(), velocities.data(), static_cast<int>(positions.size()), 1.0 / 240); });
+
+	// apply friction (per op: 256 bodies), refill velocities so they don't all reach zero
+	bench.run("vec2/apply_friction_256", 64, 2000,
+		[&] {
+			for (size_t i = 0; i < velocities.size(); i++)
+				velocities[i] = Vec2(100 + static_cast<double>(i), -50);
+		},
+		[&] { applyFriction(velocities.data(), static_cast<int>(velocities.size()), PUCK_FRICTION, PUCK_FRICTION, 1.0 / 240); });
+}
+
+// Maps a sensor point through a known lens and homography, the ground truth a calibration fit should recover
+Vec2 trueProjection(const cv::Point2f& point) {
+
+	// barrel-distorted 640x480 camera viewing the projection at a slight angle
+	const double k1 = -0.12, k2 = 0.02;
+	const double h[9] = { 720, 35, 600, -25, 690, 400, 0.04, -0.03, 1 };
+	const Vec2 center(320, 240);
+	const double scale = center.length();
+
+	// undo distortion, then apply homography
+	Vec2 e = (Vec2(point.x, point.y) - center) / scale;
+	double r2 = e.lengthSquared();
+	Vec2 u = e * (1 + k1 * r2 + k2 * r2 * r2);
+	double w = h[6] * u.x + h[7] * u.y + h[8];
+	return Vec2((h[0] * u.x + h[1] * u.y + h[2]) / w, (h[3] * u.x + h[4] * u.y + h[5]) / w);
+}
+
+// Benchmarks the camera calibration fit and per-keypoint mapping, returns false if the fit doesn't recover a known lens and homography
+bool benchmarkCalibration(Benchmark& bench) {
+
+	// largest allowed errors (px) mapping onto the projection and back to the sensor, a noise-free fit lands far below them
+	const double maxProjectionError = 0.01;
+	const double maxRoundTripError = 0.01;
+
+	// marker grid as a 640x480 camera sees it
+	std::vector<cv::Point2f> sensorPoints;
+	std::vector<Vec2> projectedPoints;
+	for (int row = 0; row < CALIBRATION_GRID_ROWS; row++)
+		for (int column = 0; column < CALIBRATION_GRID_COLUMNS; column++) {
+			cv::Point2f point(static_cast<float>(40 + 560.0 * column / (CALIBRATION_GRID_COLUMNS - 1)), static_cast<float>(40 + 400.0 * row / (CALIBRATION_GRID_ROWS - 1)));
+			sensorPoints.push_back(point);
+			projectedPoints.push_back(trueProjection(point));
+		}
+
+	// fit calibration
+	CameraCalibration calibration;
+	bool solved = calibration.solve(sensorPoints, projectedPoints, 640, 480);
+
+	// fit from the marker grid (per op: one solve)
+	bench.run("calibration/solve", 1, 200,
+		[&] { calibration.solve(sensorPoints, projectedPoints, 640, 480); });
+
+	// detections over the whole frame, between and beyond the markers, mapped once up front in case the timed runs are filtered out
+	std::vector<cv::Point2f> keypoints, remapped;
+	std::vector<Vec2> mapped;
+	for (int y = 0; y <= 480; y += 20)
+		for (int x = 0; x <= 640; x += 20) {
+			keypoints.push_back(cv::Point2f(static_cast<float>(x), static_cast<float>(y)));
+			mapped.push_back(calibration.toProjection(keypoints.back()));
+			remapped.push_back(calibration.toSensor(mapped.back()));
+		}
+	size_t next = 0;
+
+	// map detections onto the projection (per op: one keypoint)
+	bench.run("calibration/to_projection", 256, 2000,
+		[&] { size_t i = next++ % keypoints.size(); mapped[i] = calibration.toProjection(keypoints[i]); });
+
+	// map search window centers back to the sensor (per op: one point)
+	bench.run("calibration/to_sensor", 256, 2000,
+		[&] { size_t i = next++ % mapped.size(); remapped[i] = calibration.toSensor(mapped[i]); });
+
+	// check fit against the truth and the round trip back to the sensor, using the timed runs' results
+	double worstProjection = 0, worstRoundTrip = 0;
+	for (size_t i = 0; i < keypoints.size(); i++) {
+		worstProjection = std::max(worstProjection, (mapped[i] - trueProjection(keypoints[i])).length());
+		worstRoundTrip = std::max(worstRoundTrip, static_cast<double>(std::hypot(remapped[i].x - keypoints[i].x, remapped[i].y - keypoints[i].y)));
+	}
+
+	// check fit was accepted and maps within the allowed errors
+	bool accurate = (solved && worstProjection <= maxProjectionError && worstRoundTrip <= maxRoundTripError);
+
+	// report accuracy
+	std::cout << "calibration accuracy: " << (solved ? "solved" : "unsolved") << " from " << sensorPoints.size() << " markers, RMS error " << calibration.getError()
+		<< " px, max error " << worstProjection << " px over the frame, max round trip " << worstRoundTrip << " sensor px"
+		<< (accurate ? "" : " FAILED") << std::endl;
+
+	// report whether the fit was accurate
+	return accurate;
+}
+
+// Benchmarks the flare detector at several resolutions and sample strides
+void benchmarkBlobTracker(Benchmark& bench) {
+
+	// benchmark resolutions
+	const int sizes[3][2] = { { 320, 240 }, { 640, 480 }, { 1280, 720 } };
+
+	// iterate through resolutions
+	for (int s = 0; s < 3; s++) {
+		const int width = sizes[s][0];
+		const int height = sizes[s][1];
+
+		// draw frame with two flares
+		cv::Mat frame;
+		drawFlareFrame(frame, width, height, cv::Point(width / 4, height / 2), cv::Point(width * 3 / 4, height / 2));
+		std::vector<cv::KeyPoint> points;
+		points.reserve(16);
+
+		// iterate through strides (SENSOR_DOWNSAMPLE_RATIO values)
+		for (int stride = 1; stride <= 4; stride *= 2) {
+
+			// full-frame search, the path taken when a paddle is lost
+			BlobTracker tracker(SENSOR_BRIGHTNESS_THRESHOLD, SENSOR_MIN_BLOB_AREA, SENSOR_MAX_BLOB_AREA, SENSOR_BLOB_DILATION, stride);
+			bench.run("sensor/blob_detect_" + std::to_string(width) + "x" + std::to_string(height) + "_ratio" + std::to_string(stride), 1, 2000,
+				[&] { points.clear(); },
+				[&] { tracker.detect(frame, cv::Rect(0, 0, width, height), points); });
+		}
+	}
+}
+
+// Benchmarks Sensor::processFrame over a recording at several SENSOR_DOWNSAMPLE_RATIO values, looping it when it runs out
+void benchmarkProcessFrame(Benchmark& bench, const std::string& name, const std::string& recordingPath) {
+
+	// open recording as sensor source
+	Sensor sensor(&table, recordingPath);
+	sensor.detectProjectionSize();
+
+	// check if recording holds any frames
+	if (!sensor.collectFrameFromCamera()) {
+
+		// report skipped benchmark
+		std::cout << "skipped " << name << " (can't read " << recordingPath << ")" << std::endl;
+		return;
+	}
+
+	// hand one new frame to processing before each timed call (untimed), rewinding at the end
+	auto nextFrame = [&] {
+		if (!sensor.collectFrameFromCamera()) {
+			sensor.rewindReplay();
+			sensor.collectFrameFromCamera();
+		}
+		sensor.nextFrame();
+	};
+
+	// iterate through downsample ratios (detector strides), as blob_detect does
+	for (int ratio = 1; ratio <= 4; ratio *= 2) {
+
+		// time detection on the frame
+		sensor.setDownsampleRatio(ratio);
+		bench.run(name + "_ratio" + std::to_string(ratio), 1, 2000, nextFrame, [&] { sensor.processFrame(); });
+	}
+}
+
+// Benchmarks Graphics::drawGameplayImage into its offscreen buffer (never shown)
+void benchmarkGraphics(Benchmark& bench, const std::string& assetPath) {
+#ifndef AIRHOCKEY_GUI
+
+	// report skipped benchmark (harness and asset path go unused)
+	std::cout << "skipped graphics/draw_gameplay (headless build)" << std::endl;
+	(void)bench;
+	(void)assetPath;
+#else
+
+	// create graphics instance, import assets
+	Graphics graphics(&table, 0);
+	if (!graphics.importResources(assetPath)) {
+
+		// report skipped benchmark
+		std::cout << "skipped graphics/draw_gameplay (assets not found in " << assetPath << ")" << std::endl;
+		return;
+	}
+
+	// time assembling the gameplay image
+	bench.run("graphics/draw_gameplay", 1, 1000, [&] { graphics.drawGameplayImage(); });
+#endif
+}
+
+// Runs the benchmark suite: [--filter <substring>] [--quick] [--json <file>] [--assets <dir>] [--frames <recording>]
+int main(int argc, char** argv) {
+
+	// read options
+	std::string filter, jsonPath, assetPath = ASSET_PATH, framesPath;
+	bool quick = false;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (arg == "--quick")
+			quick = true;
+		else if (i + 1 < argc && arg == "--filter")
+			filter = argv[++i];
+		else if (i + 1 < argc && arg == "--json")
+			jsonPath = argv[++i];
+		else if (i + 1 < argc && arg == "--assets")
+			assetPath = argv[++i];
+		else if (i + 1 < argc && arg == "--frames")
+			framesPath = argv[++i];
+	}
+
+	// set up table and harness
+	setupTable();
+	Benchmark bench(filter, quick);
+
+	// run subsystem benchmarks
+	benchmarkPhysics(bench);
+	benchmarkMultiPuck(bench);
+	bool accurate = benchmarkPredictor(bench);
+	benchmarkVec2(bench);
+	benchmarkBlobTracker(bench);
+	accurate = benchmarkCalibration(bench) && accurate;
+
+	// check if a real recording was given, otherwise use synthetic ones
+	if (!framesPath.empty())
+		benchmarkProcessFrame(bench, "sensor/process_frame_recorded", framesPath);
+	else {
+
+		// benchmark resolutions
+		const int sizes[3][2] = { { 320, 240 }, { 640, 480 }, { 1280, 720 } };
+
+		// iterate through resolutions, with flares inside the tracking windows and outside them
+		for (int s = 0; s < 3; s++) {
+			std::string resolution = std::to_string(sizes[s][0]) + "x" + std::to_string(sizes[s][1]);
+			for (int tracked = 1; tracked >= 0; tracked--) {
+				std::string name = "sensor/process_frame_" + resolution + (tracked ? "_tracked" : "_lost");
+
+				// skip writing frames when every ratio of this case is filtered out
+				bool wanted = filter.empty();
+				for (int ratio = 1; ratio <= 4; ratio *= 2)
+					wanted = wanted || (name + "_ratio" + std::to_string(ratio)).find(filter) != std::string::npos;
+				if (!wanted)
+					continue;
+
+				// write temporary recording, benchmark it, remove it
+				std::string path = "benchmark_frames_" + resolution + ".bin";
+				if (writeFlareRecording(path, sizes[s][0], sizes[s][1], 8, tracked != 0, std::chrono::steady_clock::time_point()))
+					benchmarkProcessFrame(bench, name, path);
+				remove(path.c_str());
+			}
+		}
+
+		// restore table (sensors recalibrate it)
+		setupTable();
+	}
+
+	// run graphics benchmark
+	benchmarkGraphics(bench, assetPath);
+
+	// print results
+	bench.printTable(std::cout);
+
+	// check if machine-readable output was requested
+	if (!jsonPath.empty() && !bench.writeJson(jsonPath)) {
+
+		// report unwritable output
+		std::cout << "ERROR: Can't Write " << jsonPath << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// check if an accuracy check failed, terminate with failure so regressions fail the run
+	if (!accurate) {
+		std::cout << "ERROR: Accuracy Check Failed" << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// terminate with success
+	return EXIT_SUCCESS;
+}
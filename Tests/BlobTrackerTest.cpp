@@ -0,0 +1,111 @@
+#include "Test.h"
+#include "AllocationCounter.h"
+#include "BlobTracker.h"
+
+// Checks detection reserves enough scratch up front for the most runs a region can hold (every other pixel lit, odd widths included)
+void testBlobTrackerScratch(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("blob_tracker_scratch"))
+		return;
+
+	// iterate through odd and even region widths
+	const int widths[] = { 31, 32, 101 };
+	for (int w = 0; w < 3; w++) {
+		const int width = widths[w];
+		const int height = 20;
+		std::string name = "blob_tracker_scratch/width_" + std::to_string(width);
+
+		// dark frame, and a frame striped with one lit pixel per two columns (the most runs a row can hold)
+		cv::Mat dark, striped;
+		dark.create(height, width, CV_8UC1);
+		striped.create(height, width, CV_8UC1);
+		for (int y = 0; y < height; y++)
+			for (int x = 0; x < width; x++) {
+				dark.ptr<unsigned char>(y)[x] = 0;
+				striped.ptr<unsigned char>(y)[x] = (x % 2 == 0) ? 255 : 0;
+			}
+
+		// size scratch from the dark frame (same region size)
+		BlobTracker tracker(100, 20, 5000, SENSOR_BLOB_DILATION, 1);
+		std::vector<cv::KeyPoint> points;
+		points.reserve(64);
+		tracker.detect(dark, cv::Rect(0, 0, width, height), points);
+
+		// detect in the striped frame, counting allocations
+		unsigned long startCount = AllocationCounter::getCount();
+		tracker.detect(striped, cv::Rect(0, 0, width, height), points);
+		unsigned long allocations = AllocationCounter::getCount() - startCount;
+
+		// check run storage didn't grow mid-frame
+		std::ostringstream detail;
+		detail << allocations << " allocations";
+		test.check(name, allocations == 0, detail.str());
+	}
+}
+
+// Draws a lit disc into a single-channel frame, leaving out pixels on the given dark rows and columns (negative for none)
+static void drawDisc(cv::Mat& frame, const cv::Point& center, const int radius, const int darkRow, const int darkColumn, const int darkWidth) {
+
+	// iterate through pixels around the center
+	for (int y = center.y - radius; y <= center.y + radius; y++)
+		for (int x = center.x - radius; x <= center.x + radius; x++) {
+
+			// check if pixel is inside the disc and not on a dark stripe
+			bool inside = (x - center.x) * (x - center.x) + (y - center.y) * (y - center.y) <= radius * radius;
+			bool stripe = (darkRow >= 0 && y >= darkRow && y < darkRow + darkWidth) || (darkColumn >= 0 && x >= darkColumn && x < darkColumn + darkWidth);
+			if (inside && !stripe)
+				frame.ptr<unsigned char>(y)[x] = 255;
+		}
+}
+
+// Checks small flares and flares broken by dark gaps each come back as one blob at their center, while separate flares stay apart
+void testBlobTrackerFlares(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("blob_tracker_flares"))
+		return;
+
+	// iterate through strides (flares must hold up when sampled)
+	const int strides[] = { 1, 2 };
+	for (int s = 0; s < 2; s++) {
+		const std::string suffix = "_stride_" + std::to_string(strides[s]);
+
+		// three cases: a small flare, a flare crossed by dark stripes, and two flares well apart
+		const char* names[] = { "small", "broken", "separate" };
+		for (int c = 0; c < 3; c++) {
+			std::string name = std::string("blob_tracker_flares/") + names[c] + suffix;
+
+			// dark frame
+			cv::Mat frame;
+			frame.create(120, 160, CV_8UC1);
+			for (int y = 0; y < frame.rows; y++)
+				for (int x = 0; x < frame.cols; x++)
+					frame.ptr<unsigned char>(y)[x] = 0;
+
+			// draw case, a radius 3 flare is under SENSOR_MIN_BLOB_AREA undilated
+			if (c == 0)
+				drawDisc(frame, cv::Point(80, 60), 3, -1, -1, 0);
+			else if (c == 1)
+				drawDisc(frame, cv::Point(80, 60), 9, 59, 79, 3);
+			else {
+				drawDisc(frame, cv::Point(40, 60), 9, -1, -1, 0);
+				drawDisc(frame, cv::Point(120, 60), 9, -1, -1, 0);
+			}
+
+			// detect with the sensor's settings
+			BlobTracker tracker(SENSOR_BRIGHTNESS_THRESHOLD, SENSOR_MIN_BLOB_AREA, SENSOR_MAX_BLOB_AREA, SENSOR_BLOB_DILATION, strides[s]);
+			std::vector<cv::KeyPoint> points;
+			tracker.detect(frame, cv::Rect(0, 0, frame.cols, frame.rows), points);
+
+			// check blob count, and that a single blob sits on the flare's center
+			std::ostringstream detail;
+			detail << points.size() << " blobs";
+			for (size_t i = 0; i < points.size(); i++)
+				detail << " (" << points[i].pt.x << "," << points[i].pt.y << ")";
+			size_t expected = (c == 2) ? 2 : 1;
+			bool centered = (c == 2) || (points.size() == 1 && std::abs(points[0].pt.x - 80) <= strides[s] && std::abs(points[0].pt.y - 60) <= strides[s]);
+			test.check(name, points.size() == expected && centered, detail.str());
+		}
+	}
+}
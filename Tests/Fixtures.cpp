@@ -0,0 +1,71 @@
+#include "Fixtures.h"
+#include "FrameRecorder.h"
+
+// Publishes fully confident paddles at the given positions, paddle one moving at the given velocity (stopped by default)
+void placePaddles(TableState& table, const Vec2& paddleOne, const Vec2& paddleTwo, const Vec2& paddleOne_velocity) {
+
+	// build snapshot, captured at physics time zero so nothing is extrapolated
+	PaddleState paddles = PaddleState();
+	paddles.paddleOne_position = paddleOne;
+	paddles.paddleOne_velocity = paddleOne_velocity;
+	paddles.paddleTwo_position = paddleTwo;
+	paddles.paddleOne_confidence = 1;
+	paddles.paddleTwo_confidence = 1;
+
+	// publish snapshot
+	table.paddle_state.store(paddles);
+}
+
+// Fills a BGR frame with dim noise and two bright flares, like the IR camera sees the paddles
+void drawFlareFrame(cv::Mat& frame, const int width, const int height, const cv::Point& flareOne, const cv::Point& flareTwo) {
+
+	// allocate frame
+	frame.create(height, width, CV_8UC3);
+
+	// flare radius scales with resolution (about 9 px at 640x480)
+	const int radius = std::max(3, width / 70);
+
+	// iterate through rows
+	for (int y = 0; y < height; y++) {
+		unsigned char* pixel = frame.ptr<unsigned char>(y);
+
+		// iterate through pixels, dim background noise below the brightness threshold
+		for (int x = 0; x < width; x++) {
+			unsigned char value = static_cast<unsigned char>((x * 7 + y * 13) % 61);
+
+			// check if pixel is inside a flare
+			int d1 = (x - flareOne.x) * (x - flareOne.x) + (y - flareOne.y) * (y - flareOne.y);
+			int d2 = (x - flareTwo.x) * (x - flareTwo.x) + (y - flareTwo.y) * (y - flareTwo.y);
+			if (d1 <= radius * radius || d2 <= radius * radius)
+				value = 255;
+
+			// write pixel to all channels
+			pixel[3 * x] = value;
+			pixel[3 * x + 1] = value;
+			pixel[3 * x + 2] = value;
+		}
+	}
+}
+
+// Writes a recording of the given number of frames 1/30 s apart starting at the given capture time, flares at the default paddle positions or far from them, returns false if it can't be written
+bool writeFlareRecording(const std::string& path, const int width, const int height, const int frameCount, const bool flaresAtPaddles, const std::chrono::steady_clock::time_point& startTime) {
+
+	// open recording
+	FrameRecorder recorder(path);
+	cv::Mat frame;
+
+	// place flares where the sensor expects the paddles, or far from there so tracking falls back to a full search
+	cv::Point flareOne = flaresAtPaddles ? cv::Point(width / 4, height / 2) : cv::Point(width / 10, height / 8);
+	cv::Point flareTwo = flaresAtPaddles ? cv::Point(width * 3 / 4, height / 2) : cv::Point(width * 9 / 10, height * 7 / 8);
+
+	// write frames 1/30 s apart, flares drifting a pixel per frame so paddles move
+	auto captureTime = startTime;
+	for (int i = 0; i < frameCount; i++) {
+		drawFlareFrame(frame, width, height, flareOne + cv::Point(i % 16, i % 16), flareTwo - cv::Point(i % 16, i % 16));
+		recorder.writeFrame(frame, captureTime);
+		captureTime += std::chrono::microseconds(33333);
+	}
+
+	// report write success
+	return recorder.isOpen();
+}
@@ -0,0 +1,13 @@
+#pragma once
+#include "GameData.h"
+
+// Shared by the regression tests and the benchmarks
+
+// Publishes fully confident paddles at the given positions, paddle one moving at the given velocity (stopped by default)
+void placePaddles(TableState&, const Vec2&, const Vec2&, const Vec2& = Vec2());
+
+// Fills a BGR frame with dim noise and two bright flares, like the IR camera sees the paddles
+void drawFlareFrame(cv::Mat&, const int, const int, const cv::Point&, const cv::Point&);
+
+// Writes a recording of the given number of frames 1/30 s apart starting at the given capture time, flares at the default paddle positions or far from them, returns false if it can't be written
+bool writeFlareRecording(const std::string&, const int, const int, const int, const bool, const std::chrono::steady_clock::time_point&);
@@ -0,0 +1,165 @@
+#include "Test.h"
+#include "Fixtures.h"
+#include "AllocationCounter.h"
+#include "Physics.h"
+
+// fixed physics step (us), same as the game loop
+static const long double stepDuration_micros = 1e6L / (GRAPHICS_TARGET_FRAMERATE * PHYSICS_FRAME_RATIO);
+
+// Reports whether a puck center lies within the wall limits (goal mouths aside)
+static bool onTable(TableState& table, const Vec2& position) {
+
+	// calculate limits for the puck center imposed by the walls
+	const double lowerLimit = PUCK_RADIUS + WALL_PADDING_THICKNESS;
+	return position.x >= lowerLimit && position.x <= table.table_width - lowerLimit && position.y >= lowerLimit && position.y <= table.table_height - lowerLimit;
+}
+
+// Pins a stopped puck deep under paddle one at the given positions, steps once, checks the puck came free and stayed on the table
+static void checkPinnedPuck(Test& test, const std::string& name, const Vec2& paddle_position, const Vec2& puck_position) {
+
+	// set up table, paddle two well out of the way
+	TableState table;
+	table.setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+	Vec2 paddleTwo_position(table.table_width * 3 / 4, table.table_height / 2);
+
+	// bring paddles to rest in place with the puck far away, so the pinned step sweeps no paddle motion
+	Physics physics(&table);
+	placePaddles(table, paddle_position, paddleTwo_position);
+	physics.launchPuck(0, Vec2(table.table_width / 2, table.table_height / 2), Vec2());
+	physics.tick(stepDuration_micros, 0);
+
+	// pin puck under the paddle, one step must clear it (depenetration is closed form, never iterated)
+	physics.launchPuck(0, puck_position, Vec2());
+	physics.tick(stepDuration_micros, 0);
+
+	// check paddle no longer overlaps puck, and puck wasn't pushed through a wall to get there
+	const Vec2& resolved = physics.getState().puck_positions[0];
+	std::ostringstream detail;
+	detail << "puck ended at (" << resolved.x << ", " << resolved.y << ")";
+	test.check(name + "_cleared", !physics.hasCollision(0, true) && !physics.hasCollision(0, false), detail.str());
+	test.check(name + "_on_table", onTable(table, resolved), detail.str());
+}
+
+// Checks a puck pinned deep against a wall or into a corner by a paddle is freed in a single step
+void testDepenetration(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("physics_depenetration"))
+		return;
+
+	// table dimensions and the closest a puck center gets to a wall
+	TableState table;
+	table.setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+	const double limit = PUCK_RADIUS + WALL_PADDING_THICKNESS;
+
+	// paddle pressing puck into the "left" wall away from the goal mouth
+	checkPinnedPuck(test, "physics_depenetration/wall", Vec2(limit + 17, 150), Vec2(limit + 5, 160));
+
+	// paddle pressing puck into the "bottom" wall
+	checkPinnedPuck(test, "physics_depenetration/bottom_wall", Vec2(table.table_width / 3, table.table_height - limit - 10), Vec2(table.table_width / 3 - 4, table.table_height - limit - 1));
+
+	// paddle pressing puck diagonally into the "top left" corner
+	checkPinnedPuck(test, "physics_depenetration/corner", Vec2(limit + 17, limit + 17), Vec2(limit + 1, limit + 1));
+
+	// paddle sitting on top of a puck in the "bottom right" corner (concentric, no push direction of its own)
+	checkPinnedPuck(test, "physics_depenetration/corner_concentric", Vec2(table.table_width - limit - 2, table.table_height - limit - 2), Vec2(table.table_width - limit - 2, table.table_height - limit - 2));
+}
+
+// Checks a puck whose wall contact lands exactly at the end of a step bounces once, away from the wall
+void testWallContact(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("physics_wall_contact"))
+		return;
+
+	// set up table, paddles parked far from the "left" wall
+	TableState table;
+	table.setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+	placePaddles(table, Vec2(table.table_width / 2, table.table_height / 4), Vec2(table.table_width * 3 / 4, table.table_height / 2));
+
+	// step length (secs) as physics converts it, and the closest a puck center gets to a wall
+	const double deltaTime_secs = static_cast<double>(stepDuration_micros * 1e-6);
+	const double limit = PUCK_RADIUS + WALL_PADDING_THICKNESS;
+
+	// find a launch speed whose swept contact time rounds to exactly the step length
+	double speed = 600;
+	double start = limit + speed * deltaTime_secs;
+	while ((limit - start) / -speed != deltaTime_secs) {
+		speed += 0.125;
+		start = limit + speed * deltaTime_secs;
+	}
+
+	// bring paddles to rest first, then launch puck at the "left" wall away from the goal mouth
+	Physics physics(&table);
+	physics.launchPuck(0, Vec2(table.table_width / 2, table.table_height / 2), Vec2());
+	physics.tick(stepDuration_micros, 0);
+	physics.launchPuck(0, Vec2(start, 150), Vec2(-speed, 0));
+	physics.tick(stepDuration_micros, 0);
+
+	// check puck bounced exactly once (heading away from the wall) and rests against it
+	Vec2 position = physics.getState().puck_positions[0];
+	Vec2 velocity = physics.getState().puck_velocities[0];
+	std::ostringstream detail;
+	detail << "puck at x " << position.x << " moving " << velocity.x << " (limit " << limit << ")";
+	test.check("physics_wall_contact/bounced_once", velocity.x > 0, detail.str());
+	test.check("physics_wall_contact/against_wall", position.x >= limit && position.x < limit + 1, detail.str());
+
+	// check next step carries the puck away from the wall
+	physics.tick(stepDuration_micros, 0);
+	test.check("physics_wall_contact/leaves_wall", physics.getState().puck_positions[0].x > position.x, detail.str());
+
+	// fully inelastic walls (a sweep setting), the puck must stop against the wall it hit: "left" mid-step, "left" at the step's end, "top" mid-step
+	PhysicsParameters inelastic;
+	inelastic.wallElasticity = 0;
+	const Vec2 launchPositions[3] = { Vec2(limit + 2, 150), Vec2(start, 150), Vec2(table.table_width / 3, limit + 2) };
+	const Vec2 launchVelocities[3] = { Vec2(-600, 0), Vec2(-speed, 0), Vec2(0, -600) };
+	const int axes[3] = { 0, 0, 1 };
+	const char* names[3] = { "inelastic_left", "inelastic_left_step_end", "inelastic_top" };
+	for (int c = 0; c < 3; c++) {
+
+		// bring paddles to rest first, then launch puck at the wall
+		Physics stopping(&table, 1, inelastic);
+		stopping.launchPuck(0, Vec2(table.table_width / 2, table.table_height / 2), Vec2());
+		stopping.tick(stepDuration_micros, 0);
+		stopping.launchPuck(0, launchPositions[c], launchVelocities[c]);
+		stopping.tick(stepDuration_micros, 0);
+
+		// check puck stopped against the wall it hit, not the opposite one
+		const Vec2 stopped = stopping.getState().puck_positions[0];
+		const Vec2 stoppedVelocity = stopping.getState().puck_velocities[0];
+		std::ostringstream stoppedDetail;
+		stoppedDetail << "puck at (" << stopped.x << ", " << stopped.y << ") moving (" << stoppedVelocity.x << ", " << stoppedVelocity.y << ")";
+		test.check(std::string("physics_wall_contact/") + names[c], stopped[axes[c]] == limit && stoppedVelocity[axes[c]] == 0, stoppedDetail.str());
+	}
+}
+
+// Checks a tick with every puck crowded into one spot (the most broadphase pairs possible) makes no heap allocations
+void testCrowdedPucks(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("physics_crowded_pucks"))
+		return;
+
+	// set up table, rack the most pucks allowed
+	TableState table;
+	table.setDimensions(PROJECTOR_DEFAULT_DISTANCE);
+	placePaddles(table, Vec2(table.table_width / 4, table.table_height / 2), Vec2(table.table_width * 3 / 4, table.table_height / 2));
+	Physics physics(&table, PHYSICS_MAX_PUCKS);
+
+	// tick once with the pucks racked apart, so the broadphase has sized its per-body storage
+	physics.tick(stepDuration_micros, 0);
+
+	// stack every puck on the table center, so every pair of pucks is a candidate
+	for (int i = 0; i < PHYSICS_MAX_PUCKS; i++)
+		physics.launchPuck(i, Vec2(table.table_width / 2, table.table_height / 2), Vec2());
+
+	// tick again, counting allocations
+	unsigned long startCount = AllocationCounter::getCount();
+	physics.tick(stepDuration_micros, 0);
+	unsigned long allocations = AllocationCounter::getCount() - startCount;
+
+	// check pair storage didn't grow
+	std::ostringstream detail;
+	detail << allocations << " allocations";
+	test.check("physics_crowded_pucks/no_allocations", allocations == 0, detail.str());
+}
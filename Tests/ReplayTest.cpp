@@ -0,0 +1,44 @@
+#include "Test.h"
+#include "Fixtures.h"
+#include "ReplayRunner.h"
+
+// Replays a recording through the same runner GameTable::replayRecording uses, returns its trajectory hash
+static uint64_t hashReplay(const std::string& recordingPath) {
+
+	// open recording as sensor source
+	TableState table;
+	Sensor sensor(&table, recordingPath);
+	sensor.detectProjectionSize();
+	Physics physics(&table);
+
+	// replay every frame, report hash
+	ReplayRunner replay(&table, &sensor, &physics);
+	replay.run();
+	return replay.getTrajectoryHash();
+}
+
+// Checks replaying a recording is bit-identical whatever clock it was recorded against (before or after this machine's uptime)
+void testReplayDeterminism(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("replay_determinism"))
+		return;
+
+	// record the same frames against a clock far behind this machine's and one far ahead of it
+	const std::chrono::steady_clock::time_point offsets[2] = { std::chrono::steady_clock::time_point() + std::chrono::seconds(1), std::chrono::steady_clock::now() + std::chrono::hours(24) };
+	uint64_t hashes[2] = {};
+	for (int r = 0; r < 2; r++) {
+		std::string path = "test_replay_" + std::to_string(r) + ".bin";
+
+		// check if the recording could be written, replay it
+		if (!test.check("replay_determinism/recording_" + std::to_string(r), writeFlareRecording(path, 640, 480, 60, true, offsets[r])))
+			return;
+		hashes[r] = hashReplay(path);
+		std::remove(path.c_str());
+	}
+
+	// check both replays agree to the bit
+	std::ostringstream detail;
+	detail << std::hex << hashes[0] << " vs " << hashes[1];
+	test.check("replay_determinism/clock_offset", hashes[0] == hashes[1], detail.str());
+}
@@ -0,0 +1,200 @@
+#include "Test.h"
+#include "Fixtures.h"
+#include "AllocationCounter.h"
+#include "Sensor.h"
+
+// Replays a recording through the sensor pipeline, returns heap allocations made after the first few (warm-up) frames
+static unsigned long countSteadyStateAllocations(const std::string& recordingPath, const int frameCount) {
+
+	// open recording as sensor source
+	TableState table;
+	Sensor sensor(&table, recordingPath);
+	sensor.detectProjectionSize();
+
+	// iterate through frames, starting the count once buffers have settled
+	unsigned long startCount = 0;
+	for (int i = 0; i < frameCount; i++) {
+		if (i == 4)
+			startCount = AllocationCounter::getCount();
+
+		// capture, take, detect and filter one frame like the sensor threads do
+		sensor.collectFrameFromCamera();
+		sensor.nextFrame(0);
+		sensor.processFrame();
+		sensor.updatePaddles();
+	}
+
+	// report allocations made in steady state
+	return AllocationCounter::getCount() - startCount;
+}
+
+// Checks the sensor pipeline makes no heap allocations per frame once warmed up
+void testSensorAllocations(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("sensor_allocations"))
+		return;
+
+	// note when only operator new is visible (OpenCV buffers then go uncounted)
+	if (!AllocationCounter::countsMalloc())
+		std::cout << "note: C allocator not counted on this platform, OpenCV buffers are invisible to these checks" << std::endl;
+
+	// iterate through tracked flares (windowed search) and lost flares (full-frame search)
+	const char* names[] = { "tracked", "lost" };
+	for (int c = 0; c < 2; c++) {
+		std::string name = std::string("sensor_allocations/") + names[c];
+		std::string path = std::string("test_sensor_") + names[c] + ".bin";
+
+		// check if the recording could be written
+		if (!test.check(name + "_recording", writeFlareRecording(path, 640, 480, 24, c == 0, std::chrono::steady_clock::time_point())))
+			continue;
+
+		// replay it, no allocations allowed once warmed up
+		unsigned long allocations = countSteadyStateAllocations(path, 24);
+		std::ostringstream detail;
+		detail << allocations << " allocations in 20 frames";
+		test.check(name, allocations == 0, detail.str());
+		std::remove(path.c_str());
+	}
+}
+
+// Checks a second startRecording is refused (the first recorder keeps writing) and a failed one can be retried
+void testSensorRecording(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("sensor_recording"))
+		return;
+
+	// check if the source recording could be written
+	if (!test.check("sensor_recording/source", writeFlareRecording("test_recording_source.bin", 640, 480, 4, true, std::chrono::steady_clock::time_point())))
+		return;
+
+	// replay it through a sensor that is closed (recordings flushed) before cleanup
+	{
+		TableState table;
+		Sensor sensor(&table, "test_recording_source.bin");
+
+		// an unopenable path fails without holding on to a recorder, so the next attempt succeeds
+		test.check("sensor_recording/unopenable", !sensor.startRecording("missing_directory/test_recording.bin"));
+		test.check("sensor_recording/retry", sensor.startRecording("test_recording_first.bin"));
+
+		// a second recording while one is in progress is refused and creates no file (clear any left by an earlier run)
+		std::remove("test_recording_second.bin");
+		test.check("sensor_recording/second_refused", !sensor.startRecording("test_recording_second.bin"));
+		std::ifstream second("test_recording_second.bin");
+		test.check("sensor_recording/second_not_created", !second.is_open());
+	}
+
+	// clean up
+	std::remove("test_recording_source.bin");
+	std::remove("test_recording_first.bin");
+}
+
+// Replays every frame left in the sensor's source, returns where paddle one ends up
+static Vec2 trackPaddleOne(TableState& table, Sensor& sensor) {
+
+	// capture, take, detect and filter each frame like the sensor threads do
+	while (sensor.collectFrameFromCamera()) {
+		if (!sensor.nextFrame(0))
+			continue;
+		sensor.processFrame();
+		sensor.updatePaddles();
+	}
+
+	// report final filtered position
+	return table.paddle_state.load().paddleOne_position;
+}
+
+// Checks a recording keeps the camera calibration it was made with, so its replay maps flares where the live run did
+void testRecordingCalibration(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("recording_calibration"))
+		return;
+
+	// check if the source recording could be written
+	if (!test.check("recording_calibration/source", writeFlareRecording("test_calibration_source.bin", 640, 480, 30, true, std::chrono::steady_clock::time_point())))
+		return;
+
+	// fit a calibration that maps the frame onto the projection shifted right by a tenth of its width
+	std::vector<cv::Point2f> sensorPoints;
+	std::vector<Vec2> projectedPoints;
+	for (int row = 0; row < CALIBRATION_GRID_ROWS; row++) {
+		for (int column = 0; column < CALIBRATION_GRID_COLUMNS; column++) {
+			cv::Point2f point(64.0f + column * 512.0f / (CALIBRATION_GRID_COLUMNS - 1), 48.0f + row * 384.0f / (CALIBRATION_GRID_ROWS - 1));
+			sensorPoints.push_back(point);
+			projectedPoints.push_back(Vec2(point.x * OUTPUT_IMAGE_WIDTH / 640 + OUTPUT_IMAGE_WIDTH / 10, point.y * OUTPUT_IMAGE_HEIGHT / 480));
+		}
+	}
+	CameraCalibration shifted;
+	if (!test.check("recording_calibration/solve", shifted.solve(sensorPoints, projectedPoints, 640, 480)))
+		return;
+
+	// track the source live with the calibration, recording what the sensor sees
+	Vec2 live, replayed, uncalibrated;
+	{
+		TableState table;
+		Sensor sensor(&table, "test_calibration_source.bin");
+		sensor.detectProjectionSize();
+		sensor.setCalibration(shifted);
+		test.check("recording_calibration/recording", sensor.startRecording("test_calibration_recorded.bin"));
+		live = trackPaddleOne(table, sensor);
+	}
+
+	// replay the recording without supplying a calibration
+	double tableWidth = 0;
+	{
+		TableState table;
+		Sensor sensor(&table, "test_calibration_recorded.bin");
+		sensor.detectProjectionSize();
+		replayed = trackPaddleOne(table, sensor);
+		tableWidth = table.table_width;
+	}
+
+	// track the uncalibrated source for comparison
+	{
+		TableState table;
+		Sensor sensor(&table, "test_calibration_source.bin");
+		sensor.detectProjectionSize();
+		uncalibrated = trackPaddleOne(table, sensor);
+	}
+
+	// check the replay matches the live run and is shifted from the uncalibrated one by the calibration's tenth of the table
+	std::ostringstream detail;
+	detail << "live " << live.x << "," << live.y << " replayed " << replayed.x << "," << replayed.y << " uncalibrated " << uncalibrated.x << "," << uncalibrated.y;
+	test.check("recording_calibration/replay_matches_live", replayed.x == live.x && replayed.y == live.y, detail.str());
+	test.check("recording_calibration/calibration_applied", std::abs(replayed.x - uncalibrated.x - tableWidth / 10) < tableWidth / 100, detail.str());
+
+	// clean up
+	std::remove("test_calibration_source.bin");
+	std::remove("test_calibration_recorded.bin");
+}
+
+// Checks a camera that only returns empty grabs backs off between them and ends capture instead of spinning
+void testSensorCameraLost(Test& test) {
+
+	// check if group was filtered out
+	if (!test.group("sensor_camera_lost"))
+		return;
+
+	// open a camera index nothing is plugged into
+	TableState table;
+	Sensor sensor(&table, 99);
+
+	// grab until capture gives up (or clearly never will), timing it
+	int grabs = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int attempt = 0; attempt < 2 * SENSOR_MAX_EMPTY_GRABS && !sensor.hasSourceEnded(); attempt++)
+		if (!sensor.collectFrameFromCamera())
+			grabs++;
+	std::chrono::duration<double, std::milli> elapsed = std::chrono::steady_clock::now() - start;
+
+	// check capture ended after the allowed empty grabs, backing off between them
+	std::ostringstream detail;
+	detail << grabs << " empty grabs in " << elapsed.count() << " ms";
+	test.check("sensor_camera_lost/ended", sensor.hasSourceEnded() && grabs == SENSOR_MAX_EMPTY_GRABS, detail.str());
+	test.check("sensor_camera_lost/backed_off", elapsed.count() >= (SENSOR_MAX_EMPTY_GRABS - 1) * SENSOR_EMPTY_GRAB_BACKOFF_MS, detail.str());
+
+	// check an ended source publishes nothing more
+	test.check("sensor_camera_lost/stays_ended", !sensor.collectFrameFromCamera());
+}
@@ -0,0 +1,48 @@
+#include "Test.h"
+
+// Constructor, takes a group filter (empty runs every group)
+Test::Test(const std::string& groupFilter) {
+
+	// store filter, nothing run yet
+	filter = groupFilter;
+	checkCount = 0;
+	failureCount = 0;
+}
+
+// Reports whether a group passes the filter, announcing it if so
+bool Test::group(const std::string& name) {
+
+	// check if group was filtered out
+	if (!filter.empty() && name.find(filter) == std::string::npos)
+		return false;
+
+	// show progress as groups start
+	std::cout << "running " << name << std::endl;
+	return true;
+}
+
+// Records a check, printing its name and detail if it failed, returns whether it passed
+bool Test::check(const std::string& name, const bool passed, const std::string& detail) {
+
+	// count check
+	checkCount++;
+
+	// check if it failed, report it
+	if (!passed) {
+		failureCount++;
+		std::cout << "FAILED " << name << (detail.empty() ? "" : ": ") << detail << std::endl;
+	}
+
+	// report outcome
+	return passed;
+}
+
+// Prints a summary, returns the number of failed checks
+int Test::summarize() {
+
+	// print totals
+	std::cout << checkCount << " checks, " << failureCount << " failed" << std::endl;
+
+	// report failures
+	return failureCount;
+}
@@ -0,0 +1,59 @@
+#pragma once
+#include "GameData.h"
+#include <sstream>
+
+// Headless regression test harness, runs checks in named groups and counts failures
+class Test {
+public:
+
+	// Constructor, takes a group filter (empty runs every group)
+	Test(const std::string&);
+
+	// Reports whether a group passes the filter, announcing it if so
+	bool group(const std::string&);
+
+	// Records a check, printing its name and detail if it failed, returns whether it passed
+	bool check(const std::string&, const bool, const std::string& = "");
+
+	// Prints a summary, returns the number of failed checks
+	int summarize();
+
+private:
+
+	// substring a group name must contain to run
+	std::string filter;
+
+	// checks run and checks failed
+	int checkCount;
+	int failureCount;
+};
+
+// Checks the sensor pipeline makes no heap allocations per frame once warmed up
+void testSensorAllocations(Test&);
+
+// Checks a puck pinned deep against a wall or into a corner by a paddle is freed in a single step
+void testDepenetration(Test&);
+
+// Checks a puck whose wall contact lands exactly at the end of a step bounces once, away from the wall
+void testWallContact(Test&);
+
+// Checks replaying a recording is bit-identical whatever clock it was recorded against (before or after this machine's uptime)
+void testReplayDeterminism(Test&);
+
+// Checks a tick with every puck crowded into one spot (the most broadphase pairs possible) makes no heap allocations
+void testCrowdedPucks(Test&);
+
+// Checks detection reserves enough scratch up front for the most runs a region can hold (every other pixel lit, odd widths included)
+void testBlobTrackerScratch(Test&);
+
+// Checks a second startRecording is refused (the first recorder keeps writing) and a failed one can be retried
+void testSensorRecording(Test&);
+
+// Checks a recording keeps the camera calibration it was made with, so its replay maps flares where the live run did
+void testRecordingCalibration(Test&);
+
+// Checks small flares and flares broken by dark gaps each come back as one blob at their center, while separate flares stay apart
+void testBlobTrackerFlares(Test&);
+
+// Checks a camera that only returns empty grabs backs off between them and ends capture instead of spinning
+void testSensorCameraLost(Test&);
@@ -0,0 +1,31 @@
+#include "Test.h"
+
+// Runs the regression tests: [--filter <substring>], exits with failure if any check fails
+int main(int argc, char** argv) {
+
+	// read options
+	std::string filter;
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		if (i + 1 < argc && arg == "--filter")
+			filter = argv[++i];
+	}
+
+	// set up harness
+	Test test(filter);
+
+	// run every group (each skips itself if filtered out)
+	testBlobTrackerScratch(test);
+	testBlobTrackerFlares(test);
+	testSensorAllocations(test);
+	testSensorRecording(test);
+	testRecordingCalibration(test);
+	testSensorCameraLost(test);
+	testDepenetration(test);
+	testWallContact(test);
+	testCrowdedPucks(test);
+	testReplayDeterminism(test);
+
+	// terminate with failure if any check failed
+	return test.summarize() == 0 ? EXIT_SUCCESS : EXIT_FAILURE;
+}
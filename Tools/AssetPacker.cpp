@@ -0,0 +1,65 @@
+#include "AssetBundle.h"
+
+// check OS, include OpenCV image file headers with proper file path format
+#ifdef _WIN32
+	#include <opencv2\imgcodecs.hpp>
+#else
+	#include <opencv2/imgcodecs.hpp>
+#endif
+
+// Packs PNG assets into a pre-decoded bundle, scaled to the projection, for the game to memory-map at startup
+// Usage: airhockey_pack_assets <output bundle> <image.png>...
+int main(int argc, char** argv) {
+
+	// check for an output and at least one image
+	if (argc < 3) {
+		std::cout << "Usage: " << argv[0] << " <output bundle> <image.png>..." << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// decoded images and their names
+	std::vector<std::string> names;
+	std::vector<cv::Mat> images;
+
+	// iterate through input images
+	for (int i = 2; i < argc; i++) {
+
+		// decode image as BGR
+		std::string file = argv[i];
+		cv::Mat image = cv::imread(file, cv::IMREAD_COLOR);
+		if (image.empty()) {
+			std::cout << "ERROR: Can't Read Asset " << file << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// scale to the projection once here instead of at every launch
+		if (image.cols != OUTPUT_IMAGE_WIDTH || image.rows != OUTPUT_IMAGE_HEIGHT)
+			cv::resize(image, image, cv::Size(static_cast<int>(OUTPUT_IMAGE_WIDTH), static_cast<int>(OUTPUT_IMAGE_HEIGHT)), 0, 0, cv::INTER_AREA);
+
+		// name asset by its file stem (directory and extension dropped)
+		size_t start = file.find_last_of("/\\");
+		start = (start == std::string::npos) ? 0 : start + 1;
+		size_t end = file.find_last_of('.');
+		std::string name = file.substr(start, (end == std::string::npos || end < start) ? std::string::npos : end - start);
+
+		// check name fits a bundle entry
+		if (name.empty() || name.size() >= ASSET_NAME_LENGTH) {
+			std::cout << "ERROR: Asset Name " << name << " Must Be 1-" << (ASSET_NAME_LENGTH - 1) << " Characters" << std::endl;
+			return EXIT_FAILURE;
+		}
+
+		// add asset
+		names.push_back(name);
+		images.push_back(image);
+	}
+
+	// write bundle
+	if (!AssetBundle::pack(argv[1], names, images)) {
+		std::cout << "ERROR: Can't Write Asset Bundle " << argv[1] << std::endl;
+		return EXIT_FAILURE;
+	}
+
+	// report packed assets
+	std::cout << "Packed " << images.size() << " Asset(s) Into " << argv[1] << std::endl;
+	return EXIT_SUCCESS;
+}
@@ -0,0 +1,170 @@
+#include "BatchSimulator.h"
+#include <iomanip>
+#include <sstream>
+
+// Parses a comma-separated list of numbers, returns false if any entry isn't one or lies outside [minimum, maximum]
+bool parseValues(const std::string& list, std::vector<double>& values, const double minimum, const double maximum) {
+
+	// split on commas
+	values.clear();
+	std::stringstream stream(list);
+	std::string entry;
+	while (std::getline(stream, entry, ',')) {
+
+		// convert whole entry
+		size_t used = 0;
+		try {
+			values.push_back(std::stod(entry, &used));
+		}
+		catch (...) {
+			return false;
+		}
+		if (used != entry.size() || values.back() < minimum || values.back() > maximum)
+			return false;
+	}
+
+	// report whether the list held anything
+	return !values.empty();
+}
+
+// Runs headless games over every combination of the given physics constants and reports balance statistics per combination
+// Usage: airhockey_sweep [--games <n>] [--seconds <s>] [--workers <n>] [--paddles ai|scripted|mixed] [--seed <n>] [--csv <file>]
+//                        [--wall-elasticity <a,b,... from 0 to 1>] [--friction <a,b,...>] [--puck-radius <a,b,...>] [--goal-width <a,b,...>]
+int main(int argc, char** argv) {
+
+	// defaults, the compiled-in constants with AI paddles
+	int gamesPerSet = 64;
+	double duration_secs = 300;
+	int workerCount = 0;
+	int paddleOne_control = PADDLE_CONTROL_AI;
+	int paddleTwo_control = PADDLE_CONTROL_AI;
+	unsigned long long seed = 1;
+	std::string csvPath;
+	std::vector<double> wallElasticities(1, WALL_ELASTICITY);
+	std::vector<double> frictions(1, PUCK_FRICTION);
+	std::vector<double> puckRadii(1, PUCK_RADIUS);
+	std::vector<double> goalWidths(1, GOAL_WIDTH);
+
+	// parse command line
+	for (int i = 1; i < argc; i++) {
+		std::string arg = argv[i];
+		bool hasValue = (i + 1 < argc);
+		bool valid = hasValue;
+		if (arg == "--games" && hasValue)
+			valid = (gamesPerSet = std::atoi(argv[++i])) > 0;
+		else if (arg == "--seconds" && hasValue)
+			valid = (duration_secs = std::atof(argv[++i])) > 0;
+		else if (arg == "--workers" && hasValue)
+			valid = (workerCount = std::atoi(argv[++i])) >= 0;
+		else if (arg == "--seed" && hasValue)
+			seed = std::strtoull(argv[++i], NULL, 10);
+		else if (arg == "--csv" && hasValue)
+			csvPath = argv[++i];
+		else if (arg == "--wall-elasticity" && hasValue)
+			valid = parseValues(argv[++i], wallElasticities, 0, 1);
+		else if (arg == "--friction" && hasValue)
+			valid = parseValues(argv[++i], frictions, 0, HUGE_VAL);
+		else if (arg == "--puck-radius" && hasValue)
+			valid = parseValues(argv[++i], puckRadii, 0, HUGE_VAL);
+		else if (arg == "--goal-width" && hasValue)
+			valid = parseValues(argv[++i], goalWidths, 0, HUGE_VAL);
+		else if (arg == "--paddles" && hasValue) {
+			std::string mode = argv[++i];
+			valid = (mode == "ai" || mode == "scripted" || mode == "mixed");
+			paddleOne_control = (mode == "scripted") ? PADDLE_CONTROL_SCRIPTED : PADDLE_CONTROL_AI;
+			paddleTwo_control = (mode == "ai") ? PADDLE_CONTROL_AI : PADDLE_CONTROL_SCRIPTED;
+		}
+		else
+			valid = false;
+
+		// check argument was understood
+		if (!valid) {
+			std::cout << "ERROR: Bad Argument " << arg << std::endl;
+			std::cout << "Usage: " << argv[0] << " [--games <n>] [--seconds <s>] [--workers <n>] [--paddles ai|scripted|mixed] [--seed <n>] [--csv <file>]" << std::endl;
+			std::cout << "       [--wall-elasticity <a,b,... from 0 to 1>] [--friction <a,b,...>] [--puck-radius <a,b,...>] [--goal-width <a,b,...>]" << std::endl;
+			return EXIT_FAILURE;
+		}
+	}
+
+	// build every combination of the listed constants
+	std::vector<PhysicsParameters> sets;
+	for (size_t a = 0; a < wallElasticities.size(); a++)
+		for (size_t b = 0; b < frictions.size(); b++)
+			for (size_t c = 0; c < puckRadii.size(); c++)
+				for (size_t d = 0; d < goalWidths.size(); d++) {
+					PhysicsParameters parameters;
+					parameters.wallElasticity = wallElasticities[a];
+					parameters.puckFriction = frictions[b];
+					parameters.puckRadius = puckRadii[c];
+					parameters.goalWidth = goalWidths[d];
+					sets.push_back(parameters);
+				}
+
+	// add every set's games, each with its own serve seed
+	BatchSimulator simulator;
+	for (size_t s = 0; s < sets.size(); s++)
+		for (int g = 0; g < gamesPerSet; g++)
+			simulator.addGame(sets[s], paddleOne_control, paddleTwo_control, seed + s * gamesPerSet + g);
+
+	// run every game on a pool sized to the machine (or as asked)
+	WorkerPool pool(workerCount);
+	std::cout << "Simulating " << simulator.getGameCount() << " Game(s) of " << duration_secs << " s Across " << pool.getWorkerCount() << " Worker(s)" << std::endl;
+	std::chrono::steady_clock::time_point start = std::chrono::steady_clock::now();
+	simulator.run(pool, duration_secs);
+	double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	// open csv output if asked
+	std::ofstream csv;
+	if (!csvPath.empty()) {
+		csv.open(csvPath);
+		if (!csv.is_open()) {
+			std::cout << "ERROR: Can't Write CSV " << csvPath << std::endl;
+			return EXIT_FAILURE;
+		}
+		csv << "wall_elasticity,puck_friction,puck_radius,goal_width,games,goals_per_minute,player_one_share,mean_rally,longest_rally,peak_puck_speed,stalls_per_game" << std::endl;
+	}
+
+	// report header
+	std::cout << std::fixed << std::setprecision(2);
+	std::cout << std::setw(9) << "Elastic" << std::setw(10) << "Friction" << std::setw(8) << "Radius" << std::setw(8) << "Goal"
+		<< std::setw(10) << "Goals/min" << std::setw(8) << "P1 %" << std::setw(8) << "Rally" << std::setw(9) << "Longest"
+		<< std::setw(11) << "Peak Speed" << std::setw(8) << "Stalls" << std::endl;
+
+	// iterate through sets, games of a set are consecutive
+	for (size_t s = 0; s < sets.size(); s++) {
+
+		// combine set's games
+		double goalsPerMinute = 0, rallyHits = 0, peakSpeed = 0;
+		int goals = 0, goalsOne = 0, longestRally = 0, stalls = 0;
+		for (int g = 0; g < gamesPerSet; g++) {
+			SimulationStatistics statistics = simulator.getStatistics(static_cast<int>(s) * gamesPerSet + g);
+			int gameGoals = statistics.goals_playerOne + statistics.goals_playerTwo;
+			goalsPerMinute += statistics.goalsPerMinute;
+			rallyHits += statistics.meanRallyLength * gameGoals;
+			goals += gameGoals;
+			goalsOne += statistics.goals_playerOne;
+			longestRally = std::max(longestRally, statistics.longestRally);
+			peakSpeed = std::max(peakSpeed, statistics.peakPuckSpeed);
+			stalls += statistics.stalls;
+		}
+
+		// average over games (rallies over goals)
+		goalsPerMinute /= gamesPerSet;
+		double meanRally = (goals > 0) ? rallyHits / goals : 0;
+		double playerOneShare = (goals > 0) ? 100.0 * goalsOne / goals : 0;
+		double stallsPerGame = static_cast<double>(stalls) / gamesPerSet;
+
+		// report set
+		const PhysicsParameters& parameters = sets[s];
+		std::cout << std::setw(9) << parameters.wallElasticity << std::setw(10) << parameters.puckFriction << std::setw(8) << parameters.puckRadius << std::setw(8) << parameters.goalWidth
+			<< std::setw(10) << goalsPerMinute << std::setw(8) << playerOneShare << std::setw(8) << meanRally << std::setw(9) << longestRally
+			<< std::setw(11) << peakSpeed << std::setw(8) << stallsPerGame << std::endl;
+		if (csv.is_open())
+			csv << parameters.wallElasticity << "," << parameters.puckFriction << "," << parameters.puckRadius << "," << parameters.goalWidth << "," << gamesPerSet << ","
+				<< goalsPerMinute << "," << playerOneShare << "," << meanRally << "," << longestRally << "," << peakSpeed << "," << stallsPerGame << std::endl;
+	}
+
+	// report throughput
+	std::cout << "Simulated " << (simulator.getGameCount() * duration_secs / 3600) << " Game-Hour(s) in " << elapsed << " s" << std::endl;
+	return EXIT_SUCCESS;
+}